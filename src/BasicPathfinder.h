@@ -0,0 +1,710 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+ 
+    See the COPYING.txt file for more details.
+*/
+#ifndef BASIC_PATHFINDER_H
+#define BASIC_PATHFINDER_H
+
+#include "BucketQueue.h"
+#include "IndexedHeap.h"
+#include "NeighborList.h"
+#include "PathStats.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Header-only A* engine.  The four questions a search must answer (see
+// Pathfinder.h) are template parameters instead of std::function objects, so
+// the compiler can inline all of them into the search loop.
+//
+// Neighbors: void (int n, NeighborList &nbrs) -> add each neighbor of n
+// Cost:      int (int a, int b) -> step cost from node a to node b
+// Estimate:  int (int a) -> lower-bound estimate of cost from a to the goal
+// Goal:      bool (int n) -> true if n is the goal
+//
+// If the Cost object also has an int maxCost() const function promising that
+// no step costs more than that, the open list is a BucketQueue instead of a
+// heap.  Use boundedStepCost() to add one to a lambda.
+//
+// Use makePathfinder() to deduce the template arguments from lambdas.
+
+// Reusable working memory for searching a graph whose nodes are numbered
+// [0,n).  Node data lives in flat arrays indexed by node id.  Rather than
+// clearing the arrays between searches, each search bumps a generation counter
+// and any node stamped with an older generation is treated as unseen.  Once
+// the arrays have been sized, repeated searches don't touch the heap.
+class PathScratch
+{
+public:
+    explicit PathScratch(int numNodes = 0);
+
+    // Number of nodes this scratch space can hold.  Node ids passed to the
+    // pathfinder must be in the range [0,size()).
+    int size() const;
+    void resize(int numNodes);
+
+private:
+    template <typename N, typename C, typename E, typename G>
+    friend class BasicPathfinder;
+    template <typename N, typename RN, typename C, typename E, typename RE>
+    friend class BidirectionalPathfinder;
+    template <typename N, typename C, typename E, typename G>
+    friend class SlicedPathfinder;
+    friend class ContractionHierarchy;
+    friend class JumpPathfinder;
+    friend class DenseNodeIndex;
+    friend class HashNodeIndex;
+
+    // Invalidate all node data from the previous search.
+    void reset();
+    bool seen(int node) const;
+    void add(int node, int prev, int costSoFar);
+
+    // Make room for more nodes without disturbing the current search.
+    void grow(int numNodes);
+
+    // The open list that suits the given type of queue.
+    template <typename Queue>
+    Queue & openList();
+
+    std::vector<unsigned> generation_;
+    std::vector<int> prev_;
+    std::vector<int> costSoFar_;
+    std::vector<char> visited_;
+    IndexedHeap<> open_;
+    BucketQueue buckets_;
+    NeighborList nbrs_;
+    unsigned curGeneration_;
+};
+
+// The search works on slot numbers within a PathScratch.  These classes map
+// between graph node ids and slots.
+
+// Node ids are already dense, so they are their own slots.
+class DenseNodeIndex
+{
+public:
+    explicit DenseNodeIndex(PathScratch &scratch);
+
+    int find(int node) const;  // -1 if not seen yet this search
+    int add(int node);
+    int id(int slot) const;
+
+private:
+    PathScratch &scratch_;
+};
+
+// Node ids could be anything, so number them in the order we find them.
+class HashNodeIndex
+{
+public:
+    explicit HashNodeIndex(PathScratch &scratch);
+
+    int find(int node) const;
+    int add(int node);
+    int id(int slot) const;
+
+private:
+    PathScratch &scratch_;
+    std::unordered_map<int, int> slots_;
+    std::vector<int> ids_;
+};
+
+// Path from a search that may give up some path length for speed.  It costs
+// no more than bound times as much as the shortest path.
+struct BoundedPath
+{
+    std::vector<int> path;
+    double bound;
+};
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+class BasicPathfinder
+{
+public:
+    BasicPathfinder(Neighbors nbrs, Cost stepCost, Estimate estimate,
+                    Goal goal);
+
+    // Return the shortest path to the goal from the starting node.  Return an
+    // empty list if the goal cannot be found.  Node data goes in a hash table.
+    std::vector<int> getPathFrom(int start) const;
+
+    // Same as above, but store node data in the given scratch space.  Prefer
+    // this when node ids are dense and you run many searches over the same
+    // graph.
+    std::vector<int> getPathFrom(int start, PathScratch &scratch) const;
+
+    // Same as the above, but add counts of the work done to the given stats.
+    std::vector<int> getPathFrom(int start, PathStats &stats) const;
+    std::vector<int> getPathFrom(int start, PathScratch &scratch,
+                                 PathStats &stats) const;
+
+    // Weighted A*: multiply the estimate by weight (at least 1).  The search
+    // heads for the goal more greedily and expands fewer nodes, but the path
+    // can cost up to weight times the shortest one.  Then keep lowering the
+    // weight and improving the path (ARA*) until budget_ms runs out or the
+    // path is known to be the shortest.  A budget of 0 returns the first path
+    // found.  The bound is usually lower than the weight.
+    BoundedPath getBoundedPath(int start, double weight,
+                               double budget_ms) const;
+    BoundedPath getBoundedPath(int start, PathScratch &scratch, double weight,
+                               double budget_ms) const;
+    BoundedPath getBoundedPath(int start, double weight, double budget_ms,
+                               PathStats &stats) const;
+    BoundedPath getBoundedPath(int start, PathScratch &scratch, double weight,
+                               double budget_ms, PathStats &stats) const;
+
+private:
+    template <typename NodeIndex, typename Stats>
+    std::vector<int> search(int start, PathScratch &scratch,
+                            NodeIndex &index, Stats &stats) const;
+    template <typename NodeIndex, typename Stats>
+    BoundedPath anytimeSearch(int start, PathScratch &scratch,
+                              NodeIndex &index, double weight,
+                              double budget_ms, Stats &stats) const;
+
+    Neighbors neighbors_;
+    Cost stepCost_;
+    Estimate estimate_;
+    Goal goal_;
+};
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+BasicPathfinder<Neighbors, Cost, Estimate, Goal>
+makePathfinder(Neighbors nbrs, Cost stepCost, Estimate estimate, Goal goal)
+{
+    return {nbrs, stepCost, estimate, goal};
+}
+
+// Does the step cost function promise a maximum cost per step?
+template <typename Cost>
+class HasMaxCost
+{
+    template <typename C>
+    static char test(decltype(std::declval<const C &>().maxCost()) *);
+    template <typename C>
+    static long test(...);
+
+public:
+    static const bool value = sizeof(test<Cost>(nullptr)) == 1;
+};
+
+// Pick the open list to use with a given step cost function.
+template <typename Cost>
+using OpenListFor = typename std::conditional<HasMaxCost<Cost>::value,
+                                              BucketQueue,
+                                              IndexedHeap<>>::type;
+
+// Stock functions for the optional parts of a search.
+struct UnitStepCost
+{
+    int operator()(int, int) const { return 1; }
+    int maxCost() const { return 1; }
+};
+
+// Wrap a step cost function with a promise that no step costs more than
+// maxCost, so searches can use a BucketQueue.
+template <typename Cost>
+class BoundedStepCost
+{
+public:
+    BoundedStepCost(Cost stepCost, int maxCost)
+        : stepCost_(stepCost), maxCost_(maxCost) {}
+
+    int operator()(int a, int b) const
+    {
+        assert(stepCost_(a, b) <= maxCost_);
+        return stepCost_(a, b);
+    }
+    int maxCost() const { return maxCost_; }
+
+private:
+    Cost stepCost_;
+    int maxCost_;
+};
+
+template <typename Cost>
+BoundedStepCost<Cost> boundedStepCost(Cost stepCost, int maxCost)
+{
+    return {stepCost, maxCost};
+}
+
+struct ZeroEstimate
+{
+    int operator()(int) const { return 0; }
+};
+
+class GoalNode
+{
+public:
+    explicit GoalNode(int target) : target_(target) {}
+    bool operator()(int node) const { return node == target_; }
+
+private:
+    int target_;
+};
+
+
+inline PathScratch::PathScratch(int numNodes)
+    : generation_(),
+    prev_(),
+    costSoFar_(),
+    visited_(),
+    open_(),
+    buckets_(),
+    nbrs_(),
+    curGeneration_(0)
+{
+    resize(numNodes);
+}
+
+inline int PathScratch::size() const
+{
+    return static_cast<int>(generation_.size());
+}
+
+inline void PathScratch::resize(int numNodes)
+{
+    assert(numNodes >= 0);
+    open_.clear();
+    buckets_.clear();
+    generation_.assign(numNodes, 0);
+    prev_.resize(numNodes);
+    costSoFar_.resize(numNodes);
+    visited_.resize(numNodes);
+    open_.resize(numNodes);
+    buckets_.resize(numNodes);
+    curGeneration_ = 0;
+}
+
+inline void PathScratch::reset()
+{
+    open_.clear();
+    buckets_.clear();
+    ++curGeneration_;
+
+    // Once every 4 billion searches, the counter wraps around and old stamps
+    // could look current again.
+    if (curGeneration_ == 0) {
+        fill(std::begin(generation_), std::end(generation_), 0);
+        curGeneration_ = 1;
+    }
+}
+
+inline bool PathScratch::seen(int node) const
+{
+    return generation_[node] == curGeneration_;
+}
+
+inline void PathScratch::add(int node, int prev, int costSoFar)
+{
+    generation_[node] = curGeneration_;
+    prev_[node] = prev;
+    costSoFar_[node] = costSoFar;
+    visited_[node] = 0;
+}
+
+inline void PathScratch::grow(int numNodes)
+{
+    if (numNodes <= size()) return;
+
+    generation_.resize(numNodes, 0);
+    prev_.resize(numNodes);
+    costSoFar_.resize(numNodes);
+    visited_.resize(numNodes);
+    open_.resize(numNodes);
+    buckets_.resize(numNodes);
+}
+
+template <>
+inline IndexedHeap<> & PathScratch::openList<IndexedHeap<>>()
+{
+    return open_;
+}
+
+template <>
+inline BucketQueue & PathScratch::openList<BucketQueue>()
+{
+    return buckets_;
+}
+
+
+inline DenseNodeIndex::DenseNodeIndex(PathScratch &scratch)
+    : scratch_(scratch)
+{
+}
+
+inline int DenseNodeIndex::find(int node) const
+{
+    assert(node >= 0 && node < scratch_.size());
+    return scratch_.seen(node) ? node : -1;
+}
+
+inline int DenseNodeIndex::add(int node)
+{
+    return node;
+}
+
+inline int DenseNodeIndex::id(int slot) const
+{
+    return slot;
+}
+
+
+inline HashNodeIndex::HashNodeIndex(PathScratch &scratch)
+    : scratch_(scratch),
+    slots_(),
+    ids_()
+{
+}
+
+inline int HashNodeIndex::find(int node) const
+{
+    auto iter = slots_.find(node);
+    return iter != slots_.end() ? iter->second : -1;
+}
+
+inline int HashNodeIndex::add(int node)
+{
+    int slot = ids_.size();
+    slots_.emplace(node, slot);
+    ids_.push_back(node);
+    if (slot >= scratch_.size()) {
+        scratch_.grow(std::max(16, slot * 2));
+    }
+    return slot;
+}
+
+inline int HashNodeIndex::id(int slot) const
+{
+    return ids_[slot];
+}
+
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+BasicPathfinder<Neighbors, Cost, Estimate, Goal>::BasicPathfinder(
+        Neighbors nbrs, Cost stepCost, Estimate estimate, Goal goal)
+    : neighbors_(nbrs),
+    stepCost_(stepCost),
+    estimate_(estimate),
+    goal_(goal)
+{
+}
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+std::vector<int> BasicPathfinder<Neighbors, Cost, Estimate, Goal>::getPathFrom(
+    int start) const
+{
+    PathScratch scratch;
+    HashNodeIndex index(scratch);
+    NoStats stats;
+    return search(start, scratch, index, stats);
+}
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+std::vector<int> BasicPathfinder<Neighbors, Cost, Estimate, Goal>::getPathFrom(
+    int start, PathScratch &scratch) const
+{
+    assert(start >= 0 && start < scratch.size());
+    DenseNodeIndex index(scratch);
+    NoStats stats;
+    return search(start, scratch, index, stats);
+}
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+std::vector<int> BasicPathfinder<Neighbors, Cost, Estimate, Goal>::getPathFrom(
+    int start, PathStats &stats) const
+{
+    PathScratch scratch;
+    HashNodeIndex index(scratch);
+    return search(start, scratch, index, stats);
+}
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+std::vector<int> BasicPathfinder<Neighbors, Cost, Estimate, Goal>::getPathFrom(
+    int start, PathScratch &scratch, PathStats &stats) const
+{
+    assert(start >= 0 && start < scratch.size());
+    DenseNodeIndex index(scratch);
+    return search(start, scratch, index, stats);
+}
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+template <typename NodeIndex, typename Stats>
+std::vector<int> BasicPathfinder<Neighbors, Cost, Estimate, Goal>::search(
+    int start, PathScratch &scratch, NodeIndex &index, Stats &stats) const
+{
+    SearchTimer<Stats> timer(stats);
+    if (goal_(start)) return {start};
+
+    scratch.reset();
+    auto &open = scratch.openList<OpenListFor<Cost>>();
+    auto &nbrs = scratch.nbrs_;
+    int goalSlot = -1;
+
+    auto startSlot = index.add(start);
+    scratch.add(startSlot, -1, 0);
+    open.push(startSlot, 0);
+    stats.push(open.size());
+
+    // A* algorithm.  Decays to Dijkstra's if estimate function is always 0.
+    while (!open.empty()) {
+        auto cur = open.pop();
+        stats.pop();
+        auto loc = index.id(cur);
+        if (goal_(loc)) {
+            goalSlot = cur;
+            break;
+        }
+
+        scratch.visited_[cur] = 1;
+        stats.expand();
+        auto curCost = scratch.costSoFar_[cur];
+        nbrs.clear();
+        neighbors_(loc, nbrs);
+        for (auto n : nbrs) {
+            stats.generate();
+            auto newCost = curCost + stepCost_(loc, n);
+            auto slot = index.find(n);
+
+            if (slot != -1) {
+                // Are we on a shorter path to the neighbor node than what
+                // we've already seen?  If so, update the neighbor's node data.
+                if (scratch.visited_[slot] ||
+                    newCost >= scratch.costSoFar_[slot]) {
+                    continue;
+                }
+                scratch.prev_[slot] = cur;
+                scratch.costSoFar_[slot] = newCost;
+                open.decreaseKey(slot, newCost + estimate_(n));
+                stats.decreaseKey();
+            }
+            else {
+                // We haven't seen this node before.  Add it to the open list.
+                slot = index.add(n);
+                scratch.add(slot, cur, newCost);
+                open.push(slot, newCost + estimate_(n));
+                stats.push(open.size());
+            }
+        }
+    }
+
+    if (goalSlot == -1) {
+        return {};
+    }
+
+    // Build the path from the chain of nodes leading to the goal.
+    std::vector<int> path;
+    for (auto s = goalSlot; s != -1; s = scratch.prev_[s]) {
+        path.push_back(index.id(s));
+    }
+    reverse(std::begin(path), std::end(path));
+    return path;
+}
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+BoundedPath BasicPathfinder<Neighbors, Cost, Estimate, Goal>::getBoundedPath(
+    int start, double weight, double budget_ms) const
+{
+    PathScratch scratch;
+    HashNodeIndex index(scratch);
+    NoStats stats;
+    return anytimeSearch(start, scratch, index, weight, budget_ms, stats);
+}
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+BoundedPath BasicPathfinder<Neighbors, Cost, Estimate, Goal>::getBoundedPath(
+    int start, PathScratch &scratch, double weight, double budget_ms) const
+{
+    assert(start >= 0 && start < scratch.size());
+    DenseNodeIndex index(scratch);
+    NoStats stats;
+    return anytimeSearch(start, scratch, index, weight, budget_ms, stats);
+}
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+BoundedPath BasicPathfinder<Neighbors, Cost, Estimate, Goal>::getBoundedPath(
+    int start, double weight, double budget_ms, PathStats &stats) const
+{
+    PathScratch scratch;
+    HashNodeIndex index(scratch);
+    return anytimeSearch(start, scratch, index, weight, budget_ms, stats);
+}
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+BoundedPath BasicPathfinder<Neighbors, Cost, Estimate, Goal>::getBoundedPath(
+    int start, PathScratch &scratch, double weight, double budget_ms,
+    PathStats &stats) const
+{
+    assert(start >= 0 && start < scratch.size());
+    DenseNodeIndex index(scratch);
+    return anytimeSearch(start, scratch, index, weight, budget_ms, stats);
+}
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+template <typename NodeIndex, typename Stats>
+BoundedPath BasicPathfinder<Neighbors, Cost, Estimate, Goal>::anytimeSearch(
+    int start, PathScratch &scratch, NodeIndex &index, double weight,
+    double budget_ms, Stats &stats) const
+{
+    using Clock = std::chrono::steady_clock;
+    assert(weight >= 1.0);
+    SearchTimer<Stats> timer(stats);
+    auto deadline = Clock::now() +
+        std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::milli>(budget_ms));
+    if (goal_(start)) return {{start}, 1.0};
+
+    scratch.reset();
+    auto &open = scratch.openList<OpenListFor<Cost>>();
+    auto &nbrs = scratch.nbrs_;
+    std::vector<int> closed;
+    std::vector<int> incons;  // closed nodes whose cost went down since
+    std::vector<int> waiting;
+    int goalSlot = -1;
+    BoundedPath best = {{}, weight};
+
+    auto key = [&] (int slot) {
+        auto h = estimate_(index.id(slot));
+        return scratch.costSoFar_[slot] + static_cast<int>(weight * h);
+    };
+
+    auto startSlot = index.add(start);
+    scratch.add(startSlot, -1, 0);
+    open.push(startSlot, key(startSlot));
+    stats.push(open.size());
+
+    for (;;) {
+        // Weighted A*, except that it picks up where the last round left off.
+        // Stop once nothing left in the open list can improve on the goal at
+        // this weight.
+        int numExpanded = 0;
+        bool outOfTime = false;
+        while (!open.empty() &&
+               (goalSlot == -1 || open.topKey() < key(goalSlot)))
+        {
+            // Checking the clock is slow, so don't do it for every node.
+            if (!best.path.empty() && ++numExpanded % 256 == 0 &&
+                Clock::now() >= deadline)
+            {
+                outOfTime = true;
+                break;
+            }
+
+            auto cur = open.pop();
+            stats.pop();
+            auto loc = index.id(cur);
+            if (goal_(loc)) {
+                if (goalSlot == -1 ||
+                    scratch.costSoFar_[cur] < scratch.costSoFar_[goalSlot]) {
+                    goalSlot = cur;
+                }
+                continue;
+            }
+
+            scratch.visited_[cur] = 1;
+            closed.push_back(cur);
+            stats.expand();
+            auto curCost = scratch.costSoFar_[cur];
+            nbrs.clear();
+            neighbors_(loc, nbrs);
+            for (auto n : nbrs) {
+                stats.generate();
+                auto newCost = curCost + stepCost_(loc, n);
+                auto slot = index.find(n);
+
+                if (slot == -1) {
+                    slot = index.add(n);
+                    scratch.add(slot, cur, newCost);
+                    open.push(slot, key(slot));
+                    stats.push(open.size());
+                    continue;
+                }
+                if (newCost >= scratch.costSoFar_[slot]) continue;
+
+                // Unlike plain A*, nodes already expanded this round can
+                // still get cheaper.  Save those for the next round.
+                scratch.prev_[slot] = cur;
+                scratch.costSoFar_[slot] = newCost;
+                if (scratch.visited_[slot]) {
+                    incons.push_back(slot);
+                }
+                else if (open.contains(slot)) {
+                    open.decreaseKey(slot, key(slot));
+                    stats.decreaseKey();
+                }
+                else {
+                    open.push(slot, key(slot));
+                    stats.push(open.size());
+                }
+            }
+        }
+
+        if (outOfTime || goalSlot == -1) break;
+
+        best.path.clear();
+        for (auto s = goalSlot; s != -1; s = scratch.prev_[s]) {
+            best.path.push_back(index.id(s));
+        }
+        reverse(std::begin(best.path), std::end(best.path));
+
+        // Every other path has to go through a node that's open or waiting
+        // to be reopened, and can't cost less than its unweighted estimate.
+        waiting.clear();
+        while (!open.empty()) {
+            waiting.push_back(open.pop());
+        }
+        waiting.insert(std::end(waiting), std::begin(incons),
+                       std::end(incons));
+        incons.clear();
+        auto goalCost = scratch.costSoFar_[goalSlot];
+        auto lowerBound = goalCost;
+        for (auto s : waiting) {
+            lowerBound = std::min(lowerBound, scratch.costSoFar_[s] +
+                                  estimate_(index.id(s)));
+        }
+        if (lowerBound > 0) {
+            best.bound = std::min(weight,
+                static_cast<double>(goalCost) / lowerBound);
+        }
+        else {
+            best.bound = (goalCost == 0) ? 1.0 : weight;
+        }
+
+        if (best.bound <= 1.0 || Clock::now() >= deadline) break;
+
+        // Halve the weight each round, but never search with a weight higher
+        // than the bound we've already proven.
+        weight = std::min(best.bound, 1.0 + (weight - 1.0) / 2);
+        if (weight < 1.01) {
+            weight = 1.0;
+        }
+
+        for (auto s : closed) {
+            scratch.visited_[s] = 0;
+        }
+        closed.clear();
+        for (auto s : waiting) {
+            if (!open.contains(s)) {
+                open.push(s, key(s));
+                stats.push(open.size());
+            }
+        }
+    }
+
+    return best;
+}
+
+#endif
@@ -0,0 +1,280 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+ 
+    See the COPYING.txt file for more details.
+*/
+#ifndef BIDIRECTIONAL_PATHFINDER_H
+#define BIDIRECTIONAL_PATHFINDER_H
+
+#include "BasicPathfinder.h"
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <vector>
+
+// A* search that grows one tree forward from the start and another backward
+// from the goal, stopping when they meet on a path that provably can't be
+// beaten.  On long routes each tree covers roughly half the distance, so far
+// fewer nodes get expanded than with a one-sided search.  Only works when the
+// goal is a single known node.
+//
+// Neighbors:    void (int n, NeighborList &nbrs) -> nodes reachable from n
+// RevNeighbors: void (int n, NeighborList &nbrs) -> nodes that can reach n
+// Cost:         int (int a, int b) -> step cost from node a to node b
+// Estimate:     int (int a) -> lower-bound estimate of cost from a to goal
+// RevEstimate:  int (int a) -> lower-bound estimate of cost from start to a
+//
+// For an undirected graph, RevNeighbors is the same as Neighbors.  Both
+// estimates must be consistent (never drop by more than the step cost), which
+// hexDist() is.  Use ZeroEstimate for either one if you don't have anything
+// better.
+template <typename Neighbors, typename RevNeighbors, typename Cost,
+          typename Estimate, typename RevEstimate>
+class BidirectionalPathfinder
+{
+public:
+    BidirectionalPathfinder(Neighbors nbrs, RevNeighbors revNbrs,
+                            Cost stepCost, Estimate estimate,
+                            RevEstimate revEstimate);
+
+    // Return the shortest path from start to goal, or an empty list if there
+    // isn't one.  Node data goes in a pair of hash tables.
+    std::vector<int> getPath(int start, int goal) const;
+
+    // Same as above, but each direction of the search uses its own scratch
+    // space.
+    std::vector<int> getPath(int start, int goal, PathScratch &fwdScratch,
+                             PathScratch &revScratch) const;
+
+    // Same as the above, but add counts of the work done by both trees to the
+    // given stats.
+    std::vector<int> getPath(int start, int goal, PathStats &stats) const;
+    std::vector<int> getPath(int start, int goal, PathScratch &fwdScratch,
+                             PathScratch &revScratch, PathStats &stats) const;
+
+private:
+    template <typename NodeIndex, typename Stats>
+    std::vector<int> search(int start, int goal,
+                            PathScratch &fwd, NodeIndex &fwdIndex,
+                            PathScratch &rev, NodeIndex &revIndex,
+                            Stats &stats) const;
+
+    Neighbors neighbors_;
+    RevNeighbors revNeighbors_;
+    Cost stepCost_;
+    Estimate estimate_;
+    RevEstimate revEstimate_;
+};
+
+template <typename Neighbors, typename RevNeighbors, typename Cost,
+          typename Estimate, typename RevEstimate>
+BidirectionalPathfinder<Neighbors, RevNeighbors, Cost, Estimate, RevEstimate>
+makeBidirectionalPathfinder(Neighbors nbrs, RevNeighbors revNbrs,
+                            Cost stepCost, Estimate estimate,
+                            RevEstimate revEstimate)
+{
+    return {nbrs, revNbrs, stepCost, estimate, revEstimate};
+}
+
+
+template <typename Neighbors, typename RevNeighbors, typename Cost,
+          typename Estimate, typename RevEstimate>
+BidirectionalPathfinder<Neighbors, RevNeighbors, Cost, Estimate, RevEstimate>::
+    BidirectionalPathfinder(Neighbors nbrs, RevNeighbors revNbrs,
+                            Cost stepCost, Estimate estimate,
+                            RevEstimate revEstimate)
+    : neighbors_(nbrs),
+    revNeighbors_(revNbrs),
+    stepCost_(stepCost),
+    estimate_(estimate),
+    revEstimate_(revEstimate)
+{
+}
+
+template <typename Neighbors, typename RevNeighbors, typename Cost,
+          typename Estimate, typename RevEstimate>
+std::vector<int>
+BidirectionalPathfinder<Neighbors, RevNeighbors, Cost, Estimate, RevEstimate>::
+    getPath(int start, int goal) const
+{
+    PathScratch fwd;
+    PathScratch rev;
+    HashNodeIndex fwdIndex(fwd);
+    HashNodeIndex revIndex(rev);
+    NoStats stats;
+    return search(start, goal, fwd, fwdIndex, rev, revIndex, stats);
+}
+
+template <typename Neighbors, typename RevNeighbors, typename Cost,
+          typename Estimate, typename RevEstimate>
+std::vector<int>
+BidirectionalPathfinder<Neighbors, RevNeighbors, Cost, Estimate, RevEstimate>::
+    getPath(int start, int goal, PathScratch &fwdScratch,
+            PathScratch &revScratch) const
+{
+    assert(start >= 0 && start < fwdScratch.size());
+    assert(goal >= 0 && goal < revScratch.size());
+    DenseNodeIndex fwdIndex(fwdScratch);
+    DenseNodeIndex revIndex(revScratch);
+    NoStats stats;
+    return search(start, goal, fwdScratch, fwdIndex, revScratch, revIndex,
+                  stats);
+}
+
+template <typename Neighbors, typename RevNeighbors, typename Cost,
+          typename Estimate, typename RevEstimate>
+std::vector<int>
+BidirectionalPathfinder<Neighbors, RevNeighbors, Cost, Estimate, RevEstimate>::
+    getPath(int start, int goal, PathStats &stats) const
+{
+    PathScratch fwd;
+    PathScratch rev;
+    HashNodeIndex fwdIndex(fwd);
+    HashNodeIndex revIndex(rev);
+    return search(start, goal, fwd, fwdIndex, rev, revIndex, stats);
+}
+
+template <typename Neighbors, typename RevNeighbors, typename Cost,
+          typename Estimate, typename RevEstimate>
+std::vector<int>
+BidirectionalPathfinder<Neighbors, RevNeighbors, Cost, Estimate, RevEstimate>::
+    getPath(int start, int goal, PathScratch &fwdScratch,
+            PathScratch &revScratch, PathStats &stats) const
+{
+    assert(start >= 0 && start < fwdScratch.size());
+    assert(goal >= 0 && goal < revScratch.size());
+    DenseNodeIndex fwdIndex(fwdScratch);
+    DenseNodeIndex revIndex(revScratch);
+    return search(start, goal, fwdScratch, fwdIndex, revScratch, revIndex,
+                  stats);
+}
+
+// Both trees are ordered by the "average potential" of the two estimates
+// (Ikeda et al., 1994).  Forward keys are 2g + estimate - revEstimate and
+// reverse keys are 2g + revEstimate - estimate, which makes the search
+// equivalent to bidirectional Dijkstra's over a graph with non-negative
+// reduced step costs.  That in turn lets us stop as soon as the two smallest
+// keys add up to at least twice the best path seen so far.
+template <typename Neighbors, typename RevNeighbors, typename Cost,
+          typename Estimate, typename RevEstimate>
+template <typename NodeIndex, typename Stats>
+std::vector<int>
+BidirectionalPathfinder<Neighbors, RevNeighbors, Cost, Estimate, RevEstimate>::
+    search(int start, int goal, PathScratch &fwd, NodeIndex &fwdIndex,
+           PathScratch &rev, NodeIndex &revIndex, Stats &stats) const
+{
+    SearchTimer<Stats> timer(stats);
+    if (start == goal) return {start};
+
+    fwd.reset();
+    rev.reset();
+    using Queue = OpenListFor<Cost>;
+    auto &fwdOpen = fwd.openList<Queue>();
+    auto &revOpen = rev.openList<Queue>();
+
+    auto s = fwdIndex.add(start);
+    fwd.add(s, -1, 0);
+    fwdOpen.push(s, estimate_(start) - revEstimate_(start));
+    auto t = revIndex.add(goal);
+    rev.add(t, -1, 0);
+    revOpen.push(t, revEstimate_(goal) - estimate_(goal));
+    stats.push(1);
+    stats.push(2);
+
+    auto bestCost = std::numeric_limits<int>::max();
+    auto meetNode = -1;
+
+    while (!fwdOpen.empty() && !revOpen.empty()) {
+        if (bestCost != std::numeric_limits<int>::max() &&
+            fwdOpen.topKey() + revOpen.topKey() >= 2 * bestCost) {
+            break;
+        }
+
+        // Grow whichever tree has the smaller frontier.
+        bool forward = fwdOpen.size() <= revOpen.size();
+        auto &cur = forward ? fwd : rev;
+        auto &curOpen = forward ? fwdOpen : revOpen;
+        auto &curIndex = forward ? fwdIndex : revIndex;
+        auto &other = forward ? rev : fwd;
+        auto &otherIndex = forward ? revIndex : fwdIndex;
+
+        auto slot = curOpen.pop();
+        stats.pop();
+        stats.expand();
+        auto loc = curIndex.id(slot);
+        cur.visited_[slot] = 1;
+        auto curCost = cur.costSoFar_[slot];
+
+        auto &nbrs = cur.nbrs_;
+        nbrs.clear();
+        if (forward) {
+            neighbors_(loc, nbrs);
+        }
+        else {
+            revNeighbors_(loc, nbrs);
+        }
+
+        for (auto n : nbrs) {
+            stats.generate();
+            auto newCost = curCost + (forward ? stepCost_(loc, n) :
+                                                stepCost_(n, loc));
+            auto nSlot = curIndex.find(n);
+            if (nSlot != -1) {
+                if (cur.visited_[nSlot] || newCost >= cur.costSoFar_[nSlot]) {
+                    continue;
+                }
+                cur.prev_[nSlot] = slot;
+                cur.costSoFar_[nSlot] = newCost;
+            }
+            else {
+                nSlot = curIndex.add(n);
+                cur.add(nSlot, slot, newCost);
+            }
+
+            auto potential = forward ? estimate_(n) - revEstimate_(n) :
+                                       revEstimate_(n) - estimate_(n);
+            auto key = 2 * newCost + potential;
+            if (curOpen.contains(nSlot)) {
+                curOpen.decreaseKey(nSlot, key);
+                stats.decreaseKey();
+            }
+            else {
+                curOpen.push(nSlot, key);
+                stats.push(fwdOpen.size() + revOpen.size());
+            }
+
+            // Has the other tree already reached this node?
+            auto otherSlot = otherIndex.find(n);
+            if (otherSlot != -1 &&
+                newCost + other.costSoFar_[otherSlot] < bestCost) {
+                bestCost = newCost + other.costSoFar_[otherSlot];
+                meetNode = n;
+            }
+        }
+    }
+
+    if (meetNode == -1) {
+        return {};
+    }
+
+    // Walk back to the start from the meeting point, then forward to the goal.
+    std::vector<int> path;
+    for (auto i = fwdIndex.find(meetNode); i != -1; i = fwd.prev_[i]) {
+        path.push_back(fwdIndex.id(i));
+    }
+    reverse(std::begin(path), std::end(path));
+    for (auto i = rev.prev_[revIndex.find(meetNode)]; i != -1;
+         i = rev.prev_[i]) {
+        path.push_back(revIndex.id(i));
+    }
+    return path;
+}
+
+#endif
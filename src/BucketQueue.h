@@ -0,0 +1,257 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#ifndef BUCKET_QUEUE_H
+#define BUCKET_QUEUE_H
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+// Open list for searches whose step costs are small integers (Dial's
+// algorithm).  Nodes go in a bucket per key, so push and pop are O(1) instead
+// of O(log n).  Same interface as IndexedHeap.
+//
+// A* only ever pops keys in (roughly) increasing order, and the keys waiting
+// in the open list never span much more than a couple of step costs.  So the
+// buckets form a ring that only needs to cover that span.  If a key lands
+// outside it, the ring grows.
+//
+// Rather than search a bucket to remove a node when its key drops, we leave
+// the old entry behind and skip it when we get to it.
+class BucketQueue
+{
+public:
+    // The ring starts out big enough for searches whose steps cost at most
+    // maxStepCost.
+    explicit BucketQueue(int numNodes = 0, int maxStepCost = 1);
+
+    // Allow node ids up to numNodes-1.  Nodes already in the queue stay put.
+    void resize(int numNodes);
+
+    bool empty() const;
+    int size() const;
+    bool contains(int node) const;
+
+    // Remove all nodes.  Cost is proportional to the number of entries in the
+    // buckets, not the number of possible node ids.
+    void clear();
+
+    void push(int node, int key);
+
+    // Lower the key of a node already in the queue.
+    void decreaseKey(int node, int key);
+
+    // Return the node with the smallest key, and its key.
+    int top() const;
+    int topKey() const;
+
+    // Remove and return the node with the smallest key.
+    int pop();
+
+private:
+    struct Entry
+    {
+        int node;
+        unsigned version;  // stale if the node has been pushed again since
+    };
+
+    std::vector<Entry> & bucket(int key);
+    bool isLive(const Entry &e) const;
+    void place(int node, int key);
+
+    // Move minKey_ to the next bucket holding a live entry, discarding any
+    // stale entries along the way.
+    void advance();
+
+    // Make sure the ring covers keys from lo to hi.
+    void fit(int lo, int hi);
+
+    std::vector<std::vector<Entry>> ring_;
+    int mask_;  // ring size is a power of 2
+    int minKey_;
+    int maxKey_;  // no live key is larger, but may be an overestimate
+    int size_;
+
+    std::vector<int> key_;
+    std::vector<unsigned> version_;
+    std::vector<char> queued_;
+};
+
+
+inline BucketQueue::BucketQueue(int numNodes, int maxStepCost)
+    : ring_(),
+    mask_(0),
+    minKey_(0),
+    maxKey_(0),
+    size_(0),
+    key_(numNodes, 0),
+    version_(numNodes, 0),
+    queued_(numNodes, 0)
+{
+    assert(maxStepCost >= 0);
+
+    // Keys pushed while expanding a node are at most two step costs past it
+    // when the estimate is consistent.
+    auto ringSize = 4;
+    while (ringSize < 2 * maxStepCost + 2) {
+        ringSize *= 2;
+    }
+    ring_.resize(ringSize);
+    mask_ = ringSize - 1;
+}
+
+inline void BucketQueue::resize(int numNodes)
+{
+    key_.resize(numNodes, 0);
+    version_.resize(numNodes, 0);
+    queued_.resize(numNodes, 0);
+}
+
+inline bool BucketQueue::empty() const
+{
+    return size_ == 0;
+}
+
+inline int BucketQueue::size() const
+{
+    return size_;
+}
+
+inline bool BucketQueue::contains(int node) const
+{
+    return queued_[node] != 0;
+}
+
+inline void BucketQueue::clear()
+{
+    for (auto &b : ring_) {
+        for (const auto &e : b) {
+            queued_[e.node] = 0;
+        }
+        b.clear();
+    }
+    size_ = 0;
+}
+
+inline void BucketQueue::push(int node, int key)
+{
+    assert(!contains(node));
+    if (empty()) {
+        minKey_ = key;
+        maxKey_ = key;
+    }
+    queued_[node] = 1;
+    ++size_;
+    place(node, key);
+}
+
+inline void BucketQueue::decreaseKey(int node, int key)
+{
+    assert(contains(node));
+    assert(key <= key_[node]);
+    if (key == key_[node]) return;
+    place(node, key);
+}
+
+inline int BucketQueue::top() const
+{
+    assert(!empty());
+    return ring_[minKey_ & mask_].back().node;
+}
+
+inline int BucketQueue::topKey() const
+{
+    assert(!empty());
+    return minKey_;
+}
+
+inline int BucketQueue::pop()
+{
+    assert(!empty());
+    auto &b = bucket(minKey_);
+    auto node = b.back().node;
+    b.pop_back();
+    queued_[node] = 0;
+    --size_;
+
+    if (!empty()) {
+        advance();
+    }
+    else {
+        b.clear();
+    }
+    return node;
+}
+
+inline std::vector<BucketQueue::Entry> & BucketQueue::bucket(int key)
+{
+    return ring_[key & mask_];
+}
+
+inline bool BucketQueue::isLive(const Entry &e) const
+{
+    return queued_[e.node] && version_[e.node] == e.version;
+}
+
+inline void BucketQueue::place(int node, int key)
+{
+    fit(std::min(minKey_, key), std::max(maxKey_, key));
+    key_[node] = key;
+    ++version_[node];
+    bucket(key).push_back(Entry{node, version_[node]});
+
+    // An inconsistent estimate can produce a key lower than the smallest
+    // one we've seen.  Back up so it comes out next.
+    minKey_ = std::min(minKey_, key);
+    maxKey_ = std::max(maxKey_, key);
+}
+
+inline void BucketQueue::advance()
+{
+    for (;;) {
+        auto &b = bucket(minKey_);
+        while (!b.empty() && !isLive(b.back())) {
+            b.pop_back();
+        }
+        if (!b.empty()) return;
+
+        assert(minKey_ < maxKey_);
+        ++minKey_;
+    }
+}
+
+inline void BucketQueue::fit(int lo, int hi)
+{
+    auto ringSize = mask_ + 1;
+    if (hi - lo < ringSize) return;
+
+    while (ringSize <= hi - lo) {
+        ringSize *= 2;
+    }
+
+    // Rehash everything still waiting, in order so that ties keep popping in
+    // the same order.
+    std::vector<std::vector<Entry>> oldRing(ringSize);
+    swap(ring_, oldRing);
+    auto oldMask = mask_;
+    mask_ = ringSize - 1;
+    for (auto k = minKey_; k <= maxKey_; ++k) {
+        for (const auto &e : oldRing[k & oldMask]) {
+            if (isLive(e) && key_[e.node] == k) {
+                bucket(k).push_back(e);
+            }
+        }
+    }
+}
+
+#endif
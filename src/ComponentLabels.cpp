@@ -0,0 +1,184 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#include "ComponentLabels.h"
+#include "hex_utils.h"
+#include <cassert>
+
+ComponentLabels::ComponentLabels(const HexGrid &grid,
+                                 std::function<bool (int)> walkable)
+    : grid_(grid),
+    labels_(grid.size(), -1),
+    parent_(),
+    owner_(grid.size(), -1),
+    touched_()
+{
+    auto &queue = touched_;
+    for (int a = 0; a < grid_.size(); ++a) {
+        if (labels_[a] != -1 || !walkable(a)) continue;
+
+        auto lbl = newLabel();
+        labels_[a] = lbl;
+        queue.assign(1, a);
+        for (auto i = 0u; i < queue.size(); ++i) {
+            for (auto d : Dir()) {
+                auto n = grid_.aryGetNeighbor(queue[i], d);
+                if (n != -1 && labels_[n] == -1 && walkable(n)) {
+                    labels_[n] = lbl;
+                    queue.push_back(n);
+                }
+            }
+        }
+    }
+    queue.clear();
+}
+
+int ComponentLabels::label(int aIndex) const
+{
+    assert(aIndex >= 0 && aIndex < grid_.size());
+    auto lbl = labels_[aIndex];
+    return lbl == -1 ? -1 : find(lbl);
+}
+
+bool ComponentLabels::connected(int a, int b) const
+{
+    auto lbl = label(a);
+    return lbl != -1 && lbl == label(b);
+}
+
+void ComponentLabels::add(int aIndex)
+{
+    if (labels_[aIndex] != -1) return;
+
+    auto root = -1;
+    for (auto d : Dir()) {
+        auto n = grid_.aryGetNeighbor(aIndex, d);
+        if (n == -1 || labels_[n] == -1) continue;
+
+        auto r = find(labels_[n]);
+        if (root == -1) {
+            root = r;
+        }
+        else if (r != root) {
+            parent_[r] = root;
+        }
+    }
+    labels_[aIndex] = (root == -1 ? newLabel() : root);
+}
+
+void ComponentLabels::remove(int aIndex)
+{
+    if (labels_[aIndex] == -1) return;
+    labels_[aIndex] = -1;
+
+    // Neighbors next to each other around the hex are still connected through
+    // each other.  Start a search from each run of them.
+    const int numDirs = 6;
+    auto open = [&] (int i) {
+        auto n = grid_.aryGetNeighbor(aIndex, static_cast<Dir>(i % numDirs));
+        return n != -1 && labels_[n] != -1 ? n : -1;
+    };
+    auto firstBlocked = 0;
+    while (firstBlocked < numDirs && open(firstBlocked) != -1) {
+        ++firstBlocked;
+    }
+    if (firstBlocked == numDirs) return;
+
+    std::vector<std::vector<int>> queues;
+    for (int i = firstBlocked + 1; i <= firstBlocked + numDirs; ++i) {
+        auto n = open(i);
+        if (n != -1 && open(i - 1) == -1) {
+            queues.emplace_back(1, n);
+        }
+    }
+    auto numSearches = static_cast<int>(queues.size());
+    if (numSearches < 2) return;
+
+    // Searches that meet join the same group.  A group that runs out of hexes
+    // to visit has found an area of its own.  The last group standing keeps
+    // the old label.
+    std::vector<unsigned> next(numSearches, 0);
+    std::vector<int> group(numSearches);
+    for (int k = 0; k < numSearches; ++k) {
+        group[k] = k;
+        owner_[queues[k][0]] = k;
+        touched_.push_back(queues[k][0]);
+    }
+    auto numGroups = numSearches;
+
+    while (numGroups > 1) {
+        for (int k = 0; k < numSearches && numGroups > 1; ++k) {
+            if (group[k] == -1 || next[k] == queues[k].size()) continue;
+
+            auto cur = queues[k][next[k]];
+            ++next[k];
+            for (auto d : Dir()) {
+                auto n = grid_.aryGetNeighbor(cur, d);
+                if (n == -1 || labels_[n] == -1) continue;
+
+                if (owner_[n] == -1) {
+                    owner_[n] = k;
+                    touched_.push_back(n);
+                    queues[k].push_back(n);
+                }
+                else if (group[owner_[n]] != group[k]) {
+                    auto old = group[owner_[n]];
+                    for (auto &g : group) {
+                        if (g == old) g = group[k];
+                    }
+                    --numGroups;
+                }
+            }
+        }
+
+        for (int g = 0; g < numSearches && numGroups > 1; ++g) {
+            auto exists = false;
+            auto finished = true;
+            for (int k = 0; k < numSearches; ++k) {
+                if (group[k] != g) continue;
+                exists = true;
+                if (next[k] < queues[k].size()) finished = false;
+            }
+            if (!exists || !finished) continue;
+
+            auto lbl = newLabel();
+            for (int k = 0; k < numSearches; ++k) {
+                if (group[k] != g) continue;
+                for (auto hex : queues[k]) {
+                    labels_[hex] = lbl;
+                }
+                group[k] = -1;
+            }
+            --numGroups;
+        }
+    }
+
+    for (auto hex : touched_) {
+        owner_[hex] = -1;
+    }
+    touched_.clear();
+}
+
+int ComponentLabels::newLabel()
+{
+    parent_.push_back(parent_.size());
+    return parent_.size() - 1;
+}
+
+int ComponentLabels::find(int label) const
+{
+    while (parent_[label] != label) {
+        parent_[label] = parent_[parent_[label]];
+        label = parent_[label];
+    }
+    return label;
+}
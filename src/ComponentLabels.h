@@ -0,0 +1,59 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#ifndef COMPONENT_LABELS_H
+#define COMPONENT_LABELS_H
+
+#include "HexGrid.h"
+#include <functional>
+#include <vector>
+
+// Label each walkable hex with the connected area it belongs to, so asking
+// whether there's any path between two hexes is a lookup instead of a failed
+// search over everything reachable.
+//
+// The labels can be kept up to date as hexes open up or get blocked.  Opening
+// a hex merges the areas around it (union-find).  Blocking one might split its
+// area, so searches run out from each side at the same time.  Once all but one
+// of them meet or run out of hexes, we're done, so the work is proportional to
+// the smaller pieces.
+class ComponentLabels
+{
+public:
+    ComponentLabels(const HexGrid &grid, std::function<bool (int)> walkable);
+
+    // Label of the area containing the given hex, or -1 if it isn't walkable.
+    // Labels can change whenever a hex is added or removed.
+    int label(int aIndex) const;
+
+    // Return true if you can walk from one hex to the other.
+    bool connected(int a, int b) const;
+
+    // Call these after a hex becomes walkable, or stops being walkable.  Each
+    // hex that changes needs its own call.
+    void add(int aIndex);
+    void remove(int aIndex);
+
+private:
+    int newLabel();
+    int find(int label) const;
+
+    HexGrid grid_;
+    std::vector<int> labels_;  // for each hex, -1 if not walkable
+    mutable std::vector<int> parent_;  // labels merged by add()
+
+    // Scratch space for remove().
+    std::vector<int> owner_;
+    std::vector<int> touched_;
+};
+
+#endif
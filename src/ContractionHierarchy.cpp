@@ -0,0 +1,343 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#include "ContractionHierarchy.h"
+#include "IndexedHeap.h"
+#include "hex_utils.h"
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <utility>
+
+namespace
+{
+    // Searching for a path around a hex we're about to remove gives up after
+    // this many hexes and adds the shortcut anyway.  Extra shortcuts never
+    // make a query wrong, just a little slower.  Guessing how many shortcuts
+    // a hex would need happens far more often, so it gets a smaller limit.
+    const int witnessLimit = 200;
+    const int estimateLimit = 16;
+}
+
+ContractionHierarchy::ContractionHierarchy(const HexGrid &grid,
+                                           std::function<bool (int)> walkable)
+    : grid_(grid),
+    rank_(grid.size(), -1),
+    firstEdge_(grid.size() + 1, 0),
+    edges_(),
+    numShortcuts_(0)
+{
+    build(walkable);
+}
+
+std::vector<int> ContractionHierarchy::getPath(int aSrc, int aDest,
+                                               PathScratch &fwdScratch,
+                                               PathScratch &revScratch) const
+{
+    NoStats stats;
+    return search(aSrc, aDest, fwdScratch, revScratch, stats);
+}
+
+std::vector<int> ContractionHierarchy::getPath(int aSrc, int aDest,
+                                               PathScratch &fwdScratch,
+                                               PathScratch &revScratch,
+                                               PathStats &stats) const
+{
+    return search(aSrc, aDest, fwdScratch, revScratch, stats);
+}
+
+int ContractionHierarchy::size() const
+{
+    return grid_.size();
+}
+
+int ContractionHierarchy::numShortcuts() const
+{
+    return numShortcuts_;
+}
+
+std::size_t ContractionHierarchy::memoryUsed() const
+{
+    return rank_.capacity() * sizeof(int) +
+        firstEdge_.capacity() * sizeof(int) +
+        edges_.capacity() * sizeof(Edge);
+}
+
+void ContractionHierarchy::build(const std::function<bool (int)> &walkable)
+{
+    // Hexes not removed yet, with edges stored at both ends.
+    std::vector<std::vector<Edge>> graph(grid_.size());
+    for (int a = 0; a < grid_.size(); ++a) {
+        if (!walkable(a)) continue;
+        for (auto d : Dir()) {
+            auto n = grid_.aryGetNeighbor(a, d);
+            if (n != -1 && walkable(n)) {
+                graph[a].push_back({n, 1, -1});
+            }
+        }
+    }
+
+    // Look for the shortest way from u to every other neighbor of v that
+    // doesn't go through v.
+    PathScratch witness(grid_.size());
+    auto findWitnesses = [&] (int u, int v, int maxCost, int limit) {
+        witness.reset();
+        auto &open = witness.open_;
+        witness.add(u, -1, 0);
+        open.push(u, 0);
+        for (int i = 0; i < limit && !open.empty() &&
+             open.topKey() <= maxCost; ++i)
+        {
+            auto cur = open.pop();
+            witness.visited_[cur] = 1;
+            for (const auto &e : graph[cur]) {
+                auto newCost = witness.costSoFar_[cur] + e.cost;
+                if (e.to == v || newCost > maxCost) continue;
+                if (!witness.seen(e.to)) {
+                    witness.add(e.to, cur, newCost);
+                    open.push(e.to, newCost);
+                }
+                else if (!witness.visited_[e.to] &&
+                         newCost < witness.costSoFar_[e.to]) {
+                    witness.costSoFar_[e.to] = newCost;
+                    open.decreaseKey(e.to, newCost);
+                }
+            }
+        }
+    };
+
+    auto addEdge = [&] (int a, int b, int cost, int middle) {
+        auto &edges = graph[a];
+        auto e = find_if(std::begin(edges), std::end(edges),
+                         [b] (const Edge &edge) { return edge.to == b; });
+        if (e == std::end(edges)) {
+            edges.push_back({b, cost, middle});
+        }
+        else if (cost < e->cost) {
+            e->cost = cost;
+            e->middle = middle;
+        }
+    };
+
+    // Return the number of shortcuts needed to remove v, and add them if
+    // asked to.
+    auto contract = [&] (int v, bool addShortcuts) {
+        auto limit = addShortcuts ? witnessLimit : estimateLimit;
+        auto numShortcuts = 0;
+        const auto nbrs = graph[v];
+        auto maxCost = 0;
+        for (const auto &e : nbrs) {
+            maxCost = std::max(maxCost, e.cost);
+        }
+
+        for (auto i = 0u; i < nbrs.size(); ++i) {
+            const auto &u = nbrs[i];
+            findWitnesses(u.to, v, u.cost + maxCost, limit);
+            for (auto j = i + 1; j < nbrs.size(); ++j) {
+                const auto &w = nbrs[j];
+                auto cost = u.cost + w.cost;
+                if (witness.seen(w.to) && witness.costSoFar_[w.to] <= cost) {
+                    continue;
+                }
+                ++numShortcuts;
+                if (addShortcuts) {
+                    addEdge(u.to, w.to, cost, v);
+                    addEdge(w.to, u.to, cost, v);
+                }
+            }
+        }
+        return numShortcuts;
+    };
+
+    // Remove the hexes that add the fewest edges first.  Counting removed
+    // neighbors spreads the work evenly across the map, which keeps the
+    // searches short.
+    std::vector<int> numRemovedNbrs(grid_.size(), 0);
+    auto priority = [&] (int v) {
+        auto edgeDiff = contract(v, false) - static_cast<int>(graph[v].size());
+        return 2 * edgeDiff + numRemovedNbrs[v];
+    };
+
+    IndexedHeap<> queue(grid_.size());
+    for (int a = 0; a < grid_.size(); ++a) {
+        if (walkable(a)) {
+            queue.push(a, priority(a));
+        }
+    }
+
+    // Every hex still in the graph when v is removed ranks higher than v.
+    std::vector<std::vector<Edge>> upEdges(grid_.size());
+    auto nextRank = 0;
+    while (!queue.empty()) {
+        auto v = queue.pop();
+
+        // Priorities go stale as the graph changes.  Rather than updating the
+        // neighbors of every hex we remove, check again when a hex comes up
+        // and put it back if it's not the lowest anymore.
+        auto p = priority(v);
+        if (!queue.empty() && p > queue.topKey()) {
+            queue.push(v, p);
+            continue;
+        }
+
+        contract(v, true);
+        rank_[v] = nextRank++;
+        for (const auto &e : graph[v]) {
+            auto &nbrEdges = graph[e.to];
+            nbrEdges.erase(find_if(std::begin(nbrEdges), std::end(nbrEdges),
+                                   [v] (const Edge &edge) {
+                                       return edge.to == v;
+                                   }));
+            ++numRemovedNbrs[e.to];
+        }
+        upEdges[v].swap(graph[v]);
+    }
+
+    for (int a = 0; a < grid_.size(); ++a) {
+        firstEdge_[a] = edges_.size();
+        for (const auto &e : upEdges[a]) {
+            edges_.push_back(e);
+            if (e.middle != -1) ++numShortcuts_;
+        }
+    }
+    firstEdge_[grid_.size()] = edges_.size();
+}
+
+template <typename Stats>
+std::vector<int> ContractionHierarchy::search(int aSrc, int aDest,
+                                              PathScratch &fwd,
+                                              PathScratch &rev,
+                                              Stats &stats) const
+{
+    SearchTimer<Stats> timer(stats);
+    assert(fwd.size() >= grid_.size() && rev.size() >= grid_.size());
+    if (aSrc == aDest) return {aSrc};
+    if (rank_[aSrc] == -1 || rank_[aDest] == -1) return {};
+
+    fwd.reset();
+    rev.reset();
+    auto &fwdOpen = fwd.open_;
+    auto &revOpen = rev.open_;
+    fwd.add(aSrc, -1, 0);
+    fwdOpen.push(aSrc, 0);
+    rev.add(aDest, -1, 0);
+    revOpen.push(aDest, 0);
+    stats.push(1);
+    stats.push(2);
+
+    auto bestCost = std::numeric_limits<int>::max();
+    auto meetNode = -1;
+
+    // Each search climbs until everything left costs more than the best path
+    // found so far.
+    for (;;) {
+        bool fwdMore = !fwdOpen.empty() && fwdOpen.topKey() < bestCost;
+        bool revMore = !revOpen.empty() && revOpen.topKey() < bestCost;
+        if (!fwdMore && !revMore) break;
+
+        bool forward = fwdMore &&
+            (!revMore || fwdOpen.topKey() <= revOpen.topKey());
+        auto &cur = forward ? fwd : rev;
+        auto &curOpen = forward ? fwdOpen : revOpen;
+        auto &other = forward ? rev : fwd;
+
+        auto node = curOpen.pop();
+        stats.pop();
+        cur.visited_[node] = 1;
+        auto curCost = cur.costSoFar_[node];
+        if (other.seen(node) && curCost + other.costSoFar_[node] < bestCost) {
+            bestCost = curCost + other.costSoFar_[node];
+            meetNode = node;
+        }
+
+        // If a higher ranked hex we've already reached offers a shorter way
+        // here, no shortest path climbs through this one.
+        auto first = std::begin(edges_) + firstEdge_[node];
+        auto last = std::begin(edges_) + firstEdge_[node + 1];
+        auto stalled = [&cur, curCost] (const Edge &e) {
+            return cur.seen(e.to) && cur.costSoFar_[e.to] + e.cost < curCost;
+        };
+        if (std::any_of(first, last, stalled)) continue;
+
+        stats.expand();
+        for (auto e = first; e != last; ++e) {
+            stats.generate();
+            auto newCost = curCost + e->cost;
+            if (!cur.seen(e->to)) {
+                cur.add(e->to, node, newCost);
+                curOpen.push(e->to, newCost);
+                stats.push(fwdOpen.size() + revOpen.size());
+            }
+            else if (!cur.visited_[e->to] &&
+                     newCost < cur.costSoFar_[e->to]) {
+                cur.prev_[e->to] = node;
+                cur.costSoFar_[e->to] = newCost;
+                curOpen.decreaseKey(e->to, newCost);
+                stats.decreaseKey();
+            }
+        }
+    }
+
+    if (meetNode == -1) {
+        return {};
+    }
+
+    // Both halves climb up to the meeting point.  Fill in the hexes skipped
+    // by each edge along the way.
+    std::vector<int> upward;
+    for (auto a = meetNode; a != -1; a = fwd.prev_[a]) {
+        upward.push_back(a);
+    }
+    std::vector<int> path = {aSrc};
+    for (auto i = upward.size() - 1; i > 0; --i) {
+        unpack(upward[i], upward[i - 1], path);
+    }
+    for (auto a = meetNode; rev.prev_[a] != -1; a = rev.prev_[a]) {
+        unpack(a, rev.prev_[a], path);
+    }
+    return path;
+}
+
+void ContractionHierarchy::unpack(int a, int b, std::vector<int> &path) const
+{
+    std::vector<std::pair<int, int>> stack = {{a, b}};
+    while (!stack.empty()) {
+        auto from = stack.back().first;
+        auto to = stack.back().second;
+        stack.pop_back();
+
+        auto mid = findEdge(from, to).middle;
+        if (mid == -1) {
+            path.push_back(to);
+        }
+        else {
+            stack.emplace_back(mid, to);
+            stack.emplace_back(from, mid);
+        }
+    }
+}
+
+const ContractionHierarchy::Edge & ContractionHierarchy::findEdge(int a,
+                                                                  int b) const
+{
+    // Edges are stored with the lower ranked end.
+    if (rank_[a] > rank_[b]) {
+        std::swap(a, b);
+    }
+    auto first = std::begin(edges_) + firstEdge_[a];
+    auto last = std::begin(edges_) + firstEdge_[a + 1];
+    auto e = find_if(first, last, [b] (const Edge &edge) {
+        return edge.to == b;
+    });
+    assert(e != last);
+    return *e;
+}
@@ -0,0 +1,89 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include "BasicPathfinder.h"
+#include "HexGrid.h"
+#include "PathStats.h"
+#include <functional>
+#include <vector>
+
+// Index for finding exact shortest paths between any two hexes very quickly,
+// on a map that doesn't change.  Every step costs 1.
+//
+// How it works: rank the hexes, then remove them one at a time from lowest to
+// highest.  Whenever removing a hex would make its neighbors farther apart, add
+// a shortcut edge between them that stands in for the two steps through it.
+// Every shortest path then has a version that only climbs to higher ranked
+// hexes from both ends, so a query runs Dijkstra's algorithm upward from both
+// ends and looks for where they meet.  Each search only sees a few hundred
+// hexes even on a large map.  Shortcuts remember which hex they skip over, so
+// the full path can be filled back in.
+//
+// Building the index takes a while, so this only pays off when you have lots
+// of queries on the same map.  Build a new one if walkability changes.
+class ContractionHierarchy
+{
+public:
+    ContractionHierarchy(const HexGrid &grid,
+                         std::function<bool (int)> walkable);
+
+    // Return the shortest path between two hexes, including every hex along
+    // the way.  Return an empty list if there isn't one.  Both scratch spaces
+    // must be sized for the grid.
+    std::vector<int> getPath(int aSrc, int aDest, PathScratch &fwdScratch,
+                             PathScratch &revScratch) const;
+
+    // Same as above, but add counts of the work done to the given stats.
+    std::vector<int> getPath(int aSrc, int aDest, PathScratch &fwdScratch,
+                             PathScratch &revScratch, PathStats &stats) const;
+
+    // Number of hexes on the grid, for sizing scratch space.
+    int size() const;
+
+    // Number of edges added to skip over lower ranked hexes.
+    int numShortcuts() const;
+
+    // Bytes used by the index itself, not counting scratch space.
+    std::size_t memoryUsed() const;
+
+private:
+    // Edge to a higher ranked hex.  Shortcuts record the hex they pass
+    // through, which is lower ranked than either end.
+    struct Edge
+    {
+        int to;
+        int cost;
+        int middle;  // -1 if not a shortcut
+    };
+
+    void build(const std::function<bool (int)> &walkable);
+
+    template <typename Stats>
+    std::vector<int> search(int aSrc, int aDest, PathScratch &fwd,
+                            PathScratch &rev, Stats &stats) const;
+
+    // Add the hexes along the edge between two hexes to the path, not
+    // including the first one.
+    void unpack(int a, int b, std::vector<int> &path) const;
+    const Edge & findEdge(int a, int b) const;
+
+    HexGrid grid_;
+    std::vector<int> rank_;  // -1 if not walkable
+    std::vector<int> firstEdge_;  // edges of hex i are [firstEdge_[i],
+    std::vector<Edge> edges_;     //     firstEdge_[i + 1])
+    int numShortcuts_;
+};
+
+#endif
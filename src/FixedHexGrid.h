@@ -0,0 +1,138 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#ifndef FIXED_HEX_GRID_H
+#define FIXED_HEX_GRID_H
+
+#include "HexGrid.h"
+#include "NeighborList.h"
+#include "algo.h"
+#include "hex_utils.h"
+#include <random>
+#include <vector>
+
+// HexGrid for maps whose size is known at compile time.  Same interface, so
+// a template written against one works with the other, but the width and
+// height are constants.  Division and modulo by the width become cheap
+// arithmetic, and with constant arguments most functions fold away entirely.
+// There's no state, so every function is static.  Convert to a HexGrid to hand
+// it to code that isn't a template.
+template <int W, int H>
+class FixedHexGrid
+{
+    static_assert(W > 0 && H > 0, "grid must have at least one hex");
+
+public:
+    static constexpr int width() { return W; }
+    static constexpr int height() { return H; }
+    static constexpr int size() { return W * H; }
+
+    static constexpr Point hexFromAry(int aIndex)
+    {
+        return (aIndex < 0 || aIndex >= size()) ? Point{int_min, int_min} :
+            Point{aIndex % W, aIndex / W};
+    }
+
+    static constexpr int aryFromHex(int hx, int hy)
+    {
+        return offGrid(hx, hy) ? -1 : hy * W + hx;
+    }
+
+    static constexpr int aryFromHex(const Point &hex)
+    {
+        return aryFromHex(hex.first, hex.second);
+    }
+
+    // Return -1 for directions that aren't corners.
+    static constexpr int aryCorner(Dir d)
+    {
+        return d == Dir::NW ? 0 :
+            d == Dir::NE ? W - 1 :
+            d == Dir::SE ? size() - 1 :
+            d == Dir::SW ? size() - W :
+            -1;
+    }
+
+    static constexpr Point hexCorner(Dir d)
+    {
+        return hexFromAry(aryCorner(d));
+    }
+
+    static Point hexRandom()
+    {
+        std::uniform_int_distribution<int> dist(0, size() - 1);
+        return hexFromAry(dist(randomGenerator()));
+    }
+
+    static constexpr int aryGetNeighbor(int aSrc, Dir d)
+    {
+        return (aSrc < 0 || aSrc >= size()) ? -1 :
+            aryFromHex(aSrc % W + dx(d), aSrc / W + dy(d, aSrc % W % 2 == 1));
+    }
+
+    static constexpr Point hexGetNeighbor(const Point &hSrc, Dir d)
+    {
+        return hexFromAry(aryGetNeighbor(aryFromHex(hSrc), d));
+    }
+
+    static NeighborList aryNeighbors(int aIndex)
+    {
+        NeighborList av;
+        for (auto d : Dir()) {
+            auto aNeighbor = aryGetNeighbor(aIndex, d);
+            if (aNeighbor != -1) {
+                av.push_back(aNeighbor);
+            }
+        }
+        return av;
+    }
+
+    static std::vector<Point> hexNeighbors(const Point &hex)
+    {
+        std::vector<Point> hv;
+        for (auto aNeighbor : aryNeighbors(aryFromHex(hex))) {
+            hv.push_back(hexFromAry(aNeighbor));
+        }
+        return hv;
+    }
+
+    static constexpr bool offGrid(const Point &hex)
+    {
+        return offGrid(hex.first, hex.second);
+    }
+
+    operator HexGrid() const { return HexGrid(W, H); }
+
+private:
+    static constexpr bool offGrid(int hx, int hy)
+    {
+        return hx < 0 || hy < 0 || hx >= W || hy >= H;
+    }
+
+    // Same steps as adjacent().  Odd columns sit half a hex lower than even
+    // ones, so the diagonal directions depend on which column we're in.
+    static constexpr int dx(Dir d)
+    {
+        return (d == Dir::N || d == Dir::S) ? 0 :
+            (d == Dir::NE || d == Dir::SE) ? 1 : -1;
+    }
+
+    static constexpr int dy(Dir d, bool oddColumn)
+    {
+        return d == Dir::N ? -1 :
+            d == Dir::S ? 1 :
+            (d == Dir::NE || d == Dir::NW) ? (oddColumn ? 0 : -1) :
+            (oddColumn ? 1 : 0);
+    }
+};
+
+#endif
@@ -0,0 +1,113 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#include "FlowField.h"
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    const Uint8 noDir = static_cast<Uint8>(Dir::_last);
+
+    Dir opposite(Dir d)
+    {
+        return static_cast<Dir>((static_cast<int>(d) + 3) % 6);
+    }
+}
+
+const int FlowField::unreachable;
+
+FlowField::FlowField(const HexGrid &grid)
+    : grid_(grid),
+    dist_(grid.size(), unreachable),
+    dir_(grid.size(), noDir),
+    open_(grid.size())
+{
+}
+
+void FlowField::build(const std::vector<int> &goals,
+                      std::function<bool (int)> walkable,
+                      std::function<int (int, int)> stepCost)
+{
+    fill(std::begin(dist_), std::end(dist_), unreachable);
+    fill(std::begin(dir_), std::end(dir_), noDir);
+    open_.clear();
+
+    for (auto g : goals) {
+        assert(g >= 0 && g < grid_.size());
+        if (!walkable(g) || dist_[g] == 0) continue;
+        dist_[g] = 0;
+        open_.push(g, 0);
+    }
+
+    // Dijkstra's algorithm, but walking backward.  When we reach hex n from
+    // hex cur, a unit standing on n should step toward cur.
+    std::vector<char> done(grid_.size(), 0);
+    while (!open_.empty()) {
+        auto cur = open_.pop();
+        done[cur] = 1;
+
+        for (auto d : Dir()) {
+            auto n = grid_.aryGetNeighbor(cur, d);
+            if (n == -1 || done[n] || !walkable(n)) continue;
+
+            auto newDist = dist_[cur] + (stepCost ? stepCost(n, cur) : 1);
+            if (dist_[n] == unreachable) {
+                dist_[n] = newDist;
+                dir_[n] = static_cast<Uint8>(opposite(d));
+                open_.push(n, newDist);
+            }
+            else if (newDist < dist_[n]) {
+                dist_[n] = newDist;
+                dir_[n] = static_cast<Uint8>(opposite(d));
+                open_.decreaseKey(n, newDist);
+            }
+        }
+    }
+}
+
+int FlowField::distance(int aIndex) const
+{
+    return dist_[aIndex];
+}
+
+bool FlowField::reachable(int aIndex) const
+{
+    return dist_[aIndex] != unreachable;
+}
+
+Dir FlowField::direction(int aIndex) const
+{
+    return static_cast<Dir>(dir_[aIndex]);
+}
+
+int FlowField::nextHex(int aIndex) const
+{
+    if (dir_[aIndex] == noDir) {
+        return -1;
+    }
+
+    return grid_.aryGetNeighbor(aIndex, direction(aIndex));
+}
+
+std::vector<int> FlowField::getPathFrom(int aSrc) const
+{
+    if (!reachable(aSrc)) {
+        return {};
+    }
+
+    std::vector<int> path = {aSrc};
+    for (auto n = nextHex(aSrc); n != -1; n = nextHex(n)) {
+        path.push_back(n);
+    }
+    return path;
+}
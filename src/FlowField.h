@@ -0,0 +1,65 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+ 
+    See the COPYING.txt file for more details.
+*/
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include "HexGrid.h"
+#include "IndexedHeap.h"
+#include "hex_utils.h"
+#include <functional>
+#include <vector>
+
+// Distance to the nearest goal from every hex on the map, plus which way to
+// step to get there.  Useful when many units head for the same place: build
+// the field once with Dijkstra's algorithm running backward from the goals,
+// then each unit looks up its next move in constant time.
+//
+// The field is a snapshot.  It stays valid until the walkability or step
+// costs it was built from change; then call build() again.
+class FlowField
+{
+public:
+    static const int unreachable = -1;
+
+    explicit FlowField(const HexGrid &grid);
+
+    // Compute the field for the given goal hexes.  Units may only stand on
+    // hexes for which walkable() returns true.  stepCost(a, b) is the cost of
+    // moving from hex a to adjacent hex b; if omitted, every step costs 1.
+    void build(const std::vector<int> &goals,
+               std::function<bool (int)> walkable,
+               std::function<int (int, int)> stepCost = nullptr);
+
+    // Cost of the cheapest path to any goal, or unreachable.
+    int distance(int aIndex) const;
+    bool reachable(int aIndex) const;
+
+    // Direction of the next step toward the nearest goal.  Return Dir::_last
+    // at a goal or where no goal can be reached.
+    Dir direction(int aIndex) const;
+
+    // Hex to step to next, or -1 if there isn't one.
+    int nextHex(int aIndex) const;
+
+    // Follow the field from the given hex, including both endpoints.  Return
+    // an empty list if no goal can be reached.
+    std::vector<int> getPathFrom(int aSrc) const;
+
+private:
+    HexGrid grid_;
+    std::vector<int> dist_;
+    std::vector<Uint8> dir_;  // one Dir per hex, Dir::_last for none
+    IndexedHeap<> open_;
+};
+
+#endif
@@ -17,7 +17,7 @@
 #include <limits>
 #include <random>
 
-HexGrid::HexGrid(Sint16 width, Sint16 height)
+HexGrid::HexGrid(int width, int height)
     : width_(width),
     height_(height),
     size_(width_ * height_)
@@ -25,17 +25,17 @@ HexGrid::HexGrid(Sint16 width, Sint16 height)
     assert(width_ > 0 && height_ > 0);
 }
 
-Sint16 HexGrid::width() const
+int HexGrid::width() const
 {
     return width_;
 }
 
-Sint16 HexGrid::height() const
+int HexGrid::height() const
 {
     return height_;
 }
 
-Sint16 HexGrid::size() const
+int HexGrid::size() const
 {
     return size_;
 }
@@ -49,7 +49,7 @@ Point HexGrid::hexFromAry(int aIndex) const
     return {aIndex % width_, aIndex / width_};
 }
 
-int HexGrid::aryFromHex(Sint16 hx, Sint16 hy) const
+int HexGrid::aryFromHex(int hx, int hy) const
 {
     return aryFromHex({hx, hy});
 }
@@ -86,19 +86,33 @@ Point HexGrid::hexCorner(Dir d) const
 
 Point HexGrid::hexRandom() const
 {
-    static std::uniform_int_distribution<Sint16> dist(0, size_ - 1);
-    Sint16 aRand = dist(randomGenerator());
-    return hexFromAry(aRand);
+    std::uniform_int_distribution<int> dist(0, size_ - 1);
+    return hexFromAry(dist(randomGenerator()));
 }
 
 int HexGrid::aryGetNeighbor(int aSrc, Dir d) const
 {
-    auto neighbor = adjacent(hexFromAry(aSrc), d);
-    if (offGrid(neighbor)) {
+    if (aSrc < 0 || aSrc >= size_) {
+        return -1;
+    }
+
+    // Same steps as adjacent().  Odd columns sit half a hex lower than even
+    // ones, so the diagonal directions depend on which column we're in.
+    static const int dx[] = {0, 1, 1, 0, -1, -1};
+    static const int dyEven[] = {-1, -1, 0, 1, 0, -1};
+    static const int dyOdd[] = {-1, 0, 1, 1, 1, 0};
+
+    auto i = static_cast<int>(d);
+    assert(i >= 0 && i < 6);
+    auto hx = aSrc % width_;
+    auto hy = aSrc / width_;
+    auto nx = hx + dx[i];
+    auto ny = hy + (hx % 2 == 0 ? dyEven[i] : dyOdd[i]);
+    if (nx < 0 || nx >= width_ || ny < 0 || ny >= height_) {
         return -1;
     }
 
-    return aryFromHex(neighbor);
+    return aSrc + (ny - hy) * width_ + dx[i];
 }
 
 Point HexGrid::hexGetNeighbor(const Point &hSrc, Dir d) const
@@ -111,9 +125,9 @@ Point HexGrid::hexGetNeighbor(const Point &hSrc, Dir d) const
     return neighbor;
 }
 
-std::vector<int> HexGrid::aryNeighbors(int aIndex) const
+NeighborList HexGrid::aryNeighbors(int aIndex) const
 {
-    std::vector<int> av;
+    NeighborList av;
 
     for (auto d : Dir()) {
         auto aNeighbor = aryGetNeighbor(aIndex, d);
@@ -13,6 +13,7 @@
 #ifndef HEX_GRID_H
 #define HEX_GRID_H
 
+#include "NeighborList.h"
 #include "hex_utils.h"
 #include <vector>
 
@@ -20,17 +21,17 @@
 class HexGrid
 {
 public:
-    HexGrid(Sint16 width, Sint16 height);
+    HexGrid(int width, int height);
 
-    Sint16 width() const;
-    Sint16 height() const;
-    Sint16 size() const;
+    int width() const;
+    int height() const;
+    int size() const;
 
     // Two ways to view a hex map: a 2D map of (x,y) coordinates, and a
     // contiguous array.  These functions convert between the two
     // representations.
     Point hexFromAry(int aIndex) const;
-    int aryFromHex(Sint16 hx, Sint16 hy) const;
+    int aryFromHex(int hx, int hy) const;
     int aryFromHex(const Point &hex) const;
 
     // Accessors for the four corners of the grid.
@@ -41,21 +42,23 @@ public:
     Point hexRandom() const;
 
     // Return the neighbor hex in a given direction from the source hex.
-    // Return -1/invalid if the neighbor hex would be off the map.
+    // Return -1/invalid if the neighbor hex would be off the map.  The array
+    // version works on the index directly, without converting to a Point.
     int aryGetNeighbor(int aSrc, Dir d) const;
     Point hexGetNeighbor(const Point &hSrc, Dir d) const;
 
-    // Compute all neighbors of a given hex.  Might have fewer than 6.
-    std::vector<int> aryNeighbors(int aIndex) const;
+    // Compute all neighbors of a given hex.  Might have fewer than 6.  The
+    // array version doesn't allocate.
+    NeighborList aryNeighbors(int aIndex) const;
     std::vector<Point> hexNeighbors(const Point &hex) const;
 
     // Return true if hex is outside the grid boundary.
     bool offGrid(const Point &hex) const;
 
 private:
-    Sint16 width_;
-    Sint16 height_;
-    Sint16 size_;
+    int width_;
+    int height_;
+    int size_;
 };
 
 #endif
@@ -0,0 +1,274 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#ifndef HEX_LAYER_H
+#define HEX_LAYER_H
+
+#include "HexGrid.h"
+#include "hex_utils.h"
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+#include <vector>
+
+// One value per hex on a map, like terrain type or whether there's an
+// obstacle.  Two layouts with the same interface:
+//
+// LinearLayer stores the hexes row by row, same as a plain vector indexed by
+// HexGrid array index.
+//
+// ChunkedLayer stores square chunks of hexes (16x16 by default) one after
+// another, so hexes close together on the map are close together in memory.
+// On a wide map, stepping to the next row of a linear layer jumps a whole row
+// ahead, possibly onto another page.  Looking values up by array index costs a
+// division to find the row, so prefer at() and the iteration functions when
+// you have a hex.
+//
+// Both let you visit a rectangle of hexes or the neighbors of a hex, in
+// whatever order suits the layout.
+
+template <typename T>
+class LinearLayer
+{
+public:
+    explicit LinearLayer(const HexGrid &grid, const T &value = T());
+
+    const HexGrid & grid() const;
+    int size() const;
+
+    T & operator[](int aIndex);
+    const T & operator[](int aIndex) const;
+    T & at(const Point &hex);
+    const T & at(const Point &hex) const;
+
+    // Call f(aIndex, value) for each hex in the rectangle with the given
+    // corners, inclusive.  The part off the grid is skipped.
+    template <typename Func>
+    void forEachInRect(const Point &hNW, const Point &hSE, Func f) const;
+
+    // Call f(aNeighbor, value) for each neighbor of a hex.
+    template <typename Func>
+    void forEachNeighbor(int aIndex, Func f) const;
+
+private:
+    HexGrid grid_;
+    std::vector<T> data_;
+};
+
+template <typename T, int ChunkBits = 4>
+class ChunkedLayer
+{
+    static_assert(!std::is_same<T, bool>::value, "use char instead of bool");
+
+public:
+    static const int chunkSize = 1 << ChunkBits;
+
+    explicit ChunkedLayer(const HexGrid &grid, const T &value = T());
+
+    const HexGrid & grid() const;
+    int size() const;
+
+    T & operator[](int aIndex);
+    const T & operator[](int aIndex) const;
+    T & at(const Point &hex);
+    const T & at(const Point &hex) const;
+
+    template <typename Func>
+    void forEachInRect(const Point &hNW, const Point &hSE, Func f) const;
+
+    template <typename Func>
+    void forEachNeighbor(int aIndex, Func f) const;
+
+private:
+    int offset(int hx, int hy) const;
+
+    HexGrid grid_;
+    int chunksWide_;
+    std::vector<T> data_;  // chunks padded out to full size at the edges
+};
+
+
+template <typename T>
+LinearLayer<T>::LinearLayer(const HexGrid &grid, const T &value)
+    : grid_(grid),
+    data_(grid.size(), value)
+{
+}
+
+template <typename T>
+const HexGrid & LinearLayer<T>::grid() const
+{
+    return grid_;
+}
+
+template <typename T>
+int LinearLayer<T>::size() const
+{
+    return grid_.size();
+}
+
+template <typename T>
+T & LinearLayer<T>::operator[](int aIndex)
+{
+    return data_[aIndex];
+}
+
+template <typename T>
+const T & LinearLayer<T>::operator[](int aIndex) const
+{
+    return data_[aIndex];
+}
+
+template <typename T>
+T & LinearLayer<T>::at(const Point &hex)
+{
+    assert(!grid_.offGrid(hex));
+    return data_[hex.second * grid_.width() + hex.first];
+}
+
+template <typename T>
+const T & LinearLayer<T>::at(const Point &hex) const
+{
+    assert(!grid_.offGrid(hex));
+    return data_[hex.second * grid_.width() + hex.first];
+}
+
+template <typename T>
+template <typename Func>
+void LinearLayer<T>::forEachInRect(const Point &hNW, const Point &hSE,
+                                   Func f) const
+{
+    auto x0 = std::max(hNW.first, 0);
+    auto y0 = std::max(hNW.second, 0);
+    auto x1 = std::min(hSE.first, grid_.width() - 1);
+    auto y1 = std::min(hSE.second, grid_.height() - 1);
+    for (int hy = y0; hy <= y1; ++hy) {
+        auto aIndex = hy * grid_.width() + x0;
+        for (int hx = x0; hx <= x1; ++hx, ++aIndex) {
+            f(aIndex, data_[aIndex]);
+        }
+    }
+}
+
+template <typename T>
+template <typename Func>
+void LinearLayer<T>::forEachNeighbor(int aIndex, Func f) const
+{
+    for (auto d : Dir()) {
+        auto n = grid_.aryGetNeighbor(aIndex, d);
+        if (n != -1) {
+            f(n, data_[n]);
+        }
+    }
+}
+
+
+template <typename T, int ChunkBits>
+ChunkedLayer<T, ChunkBits>::ChunkedLayer(const HexGrid &grid, const T &value)
+    : grid_(grid),
+    chunksWide_((grid.width() + chunkSize - 1) >> ChunkBits),
+    data_()
+{
+    auto chunksHigh = (grid.height() + chunkSize - 1) >> ChunkBits;
+    data_.assign(chunksWide_ * chunksHigh * chunkSize * chunkSize, value);
+}
+
+template <typename T, int ChunkBits>
+const HexGrid & ChunkedLayer<T, ChunkBits>::grid() const
+{
+    return grid_;
+}
+
+template <typename T, int ChunkBits>
+int ChunkedLayer<T, ChunkBits>::size() const
+{
+    return grid_.size();
+}
+
+template <typename T, int ChunkBits>
+T & ChunkedLayer<T, ChunkBits>::operator[](int aIndex)
+{
+    return data_[offset(aIndex % grid_.width(), aIndex / grid_.width())];
+}
+
+template <typename T, int ChunkBits>
+const T & ChunkedLayer<T, ChunkBits>::operator[](int aIndex) const
+{
+    return data_[offset(aIndex % grid_.width(), aIndex / grid_.width())];
+}
+
+template <typename T, int ChunkBits>
+T & ChunkedLayer<T, ChunkBits>::at(const Point &hex)
+{
+    assert(!grid_.offGrid(hex));
+    return data_[offset(hex.first, hex.second)];
+}
+
+template <typename T, int ChunkBits>
+const T & ChunkedLayer<T, ChunkBits>::at(const Point &hex) const
+{
+    assert(!grid_.offGrid(hex));
+    return data_[offset(hex.first, hex.second)];
+}
+
+template <typename T, int ChunkBits>
+template <typename Func>
+void ChunkedLayer<T, ChunkBits>::forEachInRect(const Point &hNW,
+                                               const Point &hSE,
+                                               Func f) const
+{
+    auto x0 = std::max(hNW.first, 0);
+    auto y0 = std::max(hNW.second, 0);
+    auto x1 = std::min(hSE.first, grid_.width() - 1);
+    auto y1 = std::min(hSE.second, grid_.height() - 1);
+
+    // A chunk at a time, so each one is read straight through.
+    for (int cy = y0 >> ChunkBits; cy <= y1 >> ChunkBits; ++cy) {
+        auto rowMin = std::max(y0, cy << ChunkBits);
+        auto rowMax = std::min(y1, ((cy + 1) << ChunkBits) - 1);
+        for (int cx = x0 >> ChunkBits; cx <= x1 >> ChunkBits; ++cx) {
+            auto colMin = std::max(x0, cx << ChunkBits);
+            auto colMax = std::min(x1, ((cx + 1) << ChunkBits) - 1);
+            for (int hy = rowMin; hy <= rowMax; ++hy) {
+                auto aIndex = hy * grid_.width() + colMin;
+                auto value = &data_[offset(colMin, hy)];
+                for (int hx = colMin; hx <= colMax; ++hx) {
+                    f(aIndex++, *value++);
+                }
+            }
+        }
+    }
+}
+
+template <typename T, int ChunkBits>
+template <typename Func>
+void ChunkedLayer<T, ChunkBits>::forEachNeighbor(int aIndex, Func f) const
+{
+    auto hex = grid_.hexFromAry(aIndex);
+    for (auto d : Dir()) {
+        auto n = grid_.hexGetNeighbor(hex, d);
+        if (n != hInvalid) {
+            f(n.second * grid_.width() + n.first, at(n));
+        }
+    }
+}
+
+template <typename T, int ChunkBits>
+int ChunkedLayer<T, ChunkBits>::offset(int hx, int hy) const
+{
+    const int mask = chunkSize - 1;
+    auto chunk = (hy >> ChunkBits) * chunksWide_ + (hx >> ChunkBits);
+    return (chunk << (2 * ChunkBits)) + ((hy & mask) << ChunkBits) +
+        (hx & mask);
+}
+
+#endif
@@ -0,0 +1,209 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#include "IncrementalPathfinder.h"
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace
+{
+    // Large enough to never be a real path length, small enough that adding
+    // an estimate to it doesn't overflow.
+    const int infinity = std::numeric_limits<int>::max() / 4;
+}
+
+IncrementalPathfinder::IncrementalPathfinder(const HexGrid &grid,
+    std::function<bool (int)> walkable)
+    : grid_(grid),
+    walkable_(grid.size()),
+    changed_(),
+    g_(grid.size(), infinity),
+    rhs_(grid.size(), infinity),
+    open_(grid.size()),
+    start_(-1),
+    goal_(-1),
+    lastStart_(-1),
+    keyOffset_(0),
+    numExpanded_(0)
+{
+    for (int i = 0; i < grid_.size(); ++i) {
+        walkable_[i] = walkable(i);
+    }
+}
+
+void IncrementalPathfinder::setGoal(int aDest)
+{
+    assert(aDest >= 0 && aDest < grid_.size());
+    goal_ = aDest;
+    changed_.clear();
+    fill(std::begin(g_), std::end(g_), infinity);
+    fill(std::begin(rhs_), std::end(rhs_), infinity);
+    open_.clear();
+    keyOffset_ = 0;
+    numExpanded_ = 0;
+
+    rhs_[goal_] = 0;
+    if (start_ != -1) {
+        open_.push(goal_, calcKey(goal_));
+    }
+    lastStart_ = start_;
+}
+
+void IncrementalPathfinder::setStart(int aSrc)
+{
+    assert(aSrc >= 0 && aSrc < grid_.size());
+    start_ = aSrc;
+
+    // Keys depend on the start, so the goal can't be queued until we know it.
+    if (lastStart_ == -1 && goal_ != -1) {
+        lastStart_ = start_;
+        open_.push(goal_, calcKey(goal_));
+    }
+}
+
+void IncrementalPathfinder::setWalkable(int aIndex, bool walkable)
+{
+    if (walkable_[aIndex] == walkable) return;
+
+    walkable_[aIndex] = walkable;
+    changed_.push_back(aIndex);
+}
+
+bool IncrementalPathfinder::walkable(int aIndex) const
+{
+    return walkable_[aIndex] != 0;
+}
+
+std::vector<int> IncrementalPathfinder::getPath()
+{
+    assert(start_ != -1 && goal_ != -1);
+
+    // Keys already in the open list were computed relative to an older start.
+    // Rather than redo all of them, raise the bar for new keys by how far the
+    // start has moved.  This keeps the estimates a lower bound.
+    if (!changed_.empty()) {
+        keyOffset_ += estimate(lastStart_, start_);
+        lastStart_ = start_;
+        for (auto a : changed_) {
+            updateHex(a);
+            for (auto n : grid_.aryNeighbors(a)) {
+                updateHex(n);
+            }
+        }
+        changed_.clear();
+    }
+
+    computeShortestPath();
+    if (!walkable(start_) || g_[start_] >= infinity) {
+        return {};
+    }
+
+    // Walk downhill from the start.
+    std::vector<int> path = {start_};
+    auto cur = start_;
+    while (cur != goal_) {
+        auto next = -1;
+        auto best = infinity;
+        for (auto n : grid_.aryNeighbors(cur)) {
+            if (walkable(n) && g_[n] < best) {
+                best = g_[n];
+                next = n;
+            }
+        }
+        if (next == -1 || path.size() > g_.size()) return {};
+        path.push_back(next);
+        cur = next;
+    }
+    return path;
+}
+
+int IncrementalPathfinder::numExpanded() const
+{
+    return numExpanded_;
+}
+
+int IncrementalPathfinder::estimate(int aFrom, int aTo) const
+{
+    return hexDist(grid_.hexFromAry(aFrom), grid_.hexFromAry(aTo));
+}
+
+IncrementalPathfinder::Key IncrementalPathfinder::calcKey(int aIndex) const
+{
+    auto cost = std::min(g_[aIndex], rhs_[aIndex]);
+    if (cost >= infinity) {
+        return {infinity, infinity};
+    }
+    return {cost + estimate(start_, aIndex) + keyOffset_, cost};
+}
+
+void IncrementalPathfinder::updateHex(int aIndex)
+{
+    if (aIndex != goal_) {
+        auto best = infinity;
+        if (walkable(aIndex)) {
+            for (auto n : grid_.aryNeighbors(aIndex)) {
+                if (walkable(n)) {
+                    best = std::min(best, g_[n] + 1);
+                }
+            }
+        }
+        rhs_[aIndex] = std::min(best, infinity);
+    }
+
+    auto consistent = (g_[aIndex] == rhs_[aIndex]);
+    if (open_.contains(aIndex)) {
+        if (consistent) {
+            open_.remove(aIndex);
+        }
+        else {
+            open_.update(aIndex, calcKey(aIndex));
+        }
+    }
+    else if (!consistent) {
+        open_.push(aIndex, calcKey(aIndex));
+    }
+}
+
+void IncrementalPathfinder::computeShortestPath()
+{
+    while (!open_.empty() &&
+           (open_.topKey() < calcKey(start_) ||
+            rhs_[start_] != g_[start_])) {
+        auto cur = open_.top();
+        auto oldKey = open_.topKey();
+        auto newKey = calcKey(cur);
+        ++numExpanded_;
+
+        if (oldKey < newKey) {
+            // Queued before the start moved.  Try again with the right key.
+            open_.update(cur, newKey);
+        }
+        else if (g_[cur] > rhs_[cur]) {
+            // Got cheaper.  Settle it and tell the neighbors.
+            g_[cur] = rhs_[cur];
+            open_.pop();
+            for (auto n : grid_.aryNeighbors(cur)) {
+                updateHex(n);
+            }
+        }
+        else {
+            // Got more expensive.  Start over on this hex and everything
+            // that might have depended on it.
+            g_[cur] = infinity;
+            updateHex(cur);
+            for (auto n : grid_.aryNeighbors(cur)) {
+                updateHex(n);
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+ 
+    See the COPYING.txt file for more details.
+*/
+#ifndef INCREMENTAL_PATHFINDER_H
+#define INCREMENTAL_PATHFINDER_H
+
+#include "HexGrid.h"
+#include "IndexedHeap.h"
+#include "hex_utils.h"
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Shortest paths to a fixed goal that stay cheap to recompute as obstacles
+// come and go, using D* Lite (Koenig and Likhachev, 2002).  Every step costs
+// 1.
+//
+// The search runs backward from the goal and keeps its results between
+// queries.  When some hexes change walkability, only the hexes whose
+// distance to the goal actually changed get searched again.  The start can
+// move too, which is what a unit following the path does.
+class IncrementalPathfinder
+{
+public:
+    IncrementalPathfinder(const HexGrid &grid,
+                          std::function<bool (int)> walkable);
+
+    // Changing the goal throws away everything learned so far.
+    void setGoal(int aDest);
+    void setStart(int aSrc);
+
+    // Record a change in walkability.  The repair happens during the next
+    // getPath().
+    void setWalkable(int aIndex, bool walkable);
+    bool walkable(int aIndex) const;
+
+    // Return the shortest path from the start to the goal, including both.
+    // Return an empty list if there isn't one.
+    std::vector<int> getPath();
+
+    // Number of hexes expanded by all searches since the goal was set.
+    int numExpanded() const;
+
+private:
+    using Key = std::pair<int, int>;
+
+    int estimate(int aFrom, int aTo) const;
+    Key calcKey(int aIndex) const;
+    void updateHex(int aIndex);
+    void computeShortestPath();
+
+    HexGrid grid_;
+    std::vector<char> walkable_;
+    std::vector<int> changed_;  // hexes that flipped since the last search
+
+    // Cost to the goal as of the last expansion (g), and as implied by the
+    // neighbors' costs (rhs).  A hex needs another look when they disagree.
+    std::vector<int> g_;
+    std::vector<int> rhs_;
+    IndexedHeap<4, Key> open_;
+
+    int start_;
+    int goal_;
+    int lastStart_;  // start when costs last changed
+    int keyOffset_;  // how far the start has moved since the first search
+    int numExpanded_;
+};
+
+#endif
@@ -0,0 +1,241 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+ 
+    See the COPYING.txt file for more details.
+*/
+#ifndef INDEXED_HEAP_H
+#define INDEXED_HEAP_H
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+// Min-heap of node ids [0,n) ordered by a key, with D children per node.  The
+// heap remembers where each node lives so that decreaseKey() can move it in
+// O(log n) instead of rebuilding the whole heap.  Keys are ints unless you
+// need something else that supports operator<, such as a std::pair.
+template <int D = 4, typename Key = int>
+class IndexedHeap
+{
+public:
+    explicit IndexedHeap(int numNodes = 0);
+
+    // Allow node ids up to numNodes-1.  Nodes already in the heap stay put.
+    void resize(int numNodes);
+
+    bool empty() const;
+    int size() const;
+    bool contains(int node) const;
+
+    // Remove all nodes.  Cost is proportional to the number of nodes in the
+    // heap, not the number of possible node ids.
+    void clear();
+
+    void push(int node, Key key);
+
+    // Lower the key of a node already in the heap.
+    void decreaseKey(int node, Key key);
+
+    // Change the key of a node already in the heap, up or down.
+    void update(int node, Key key);
+
+    // Return the node with the smallest key, and its key.
+    int top() const;
+    Key topKey() const;
+
+    // Remove and return the node with the smallest key.
+    int pop();
+
+    // Remove a node from anywhere in the heap.
+    void remove(int node);
+
+private:
+    struct Entry
+    {
+        Key key;
+        int node;
+    };
+
+    void place(int i, const Entry &e);
+    void siftUp(int i);
+    void siftDown(int i);
+
+    std::vector<Entry> heap_;
+    std::vector<int> pos_;  // index of each node in heap_, or -1
+};
+
+template <int D, typename Key>
+IndexedHeap<D, Key>::IndexedHeap(int numNodes)
+    : heap_(),
+    pos_(numNodes, -1)
+{
+    static_assert(D >= 2, "heap needs at least two children per node");
+}
+
+template <int D, typename Key>
+void IndexedHeap<D, Key>::resize(int numNodes)
+{
+    pos_.resize(numNodes, -1);
+}
+
+template <int D, typename Key>
+bool IndexedHeap<D, Key>::empty() const
+{
+    return heap_.empty();
+}
+
+template <int D, typename Key>
+int IndexedHeap<D, Key>::size() const
+{
+    return static_cast<int>(heap_.size());
+}
+
+template <int D, typename Key>
+bool IndexedHeap<D, Key>::contains(int node) const
+{
+    return pos_[node] != -1;
+}
+
+template <int D, typename Key>
+void IndexedHeap<D, Key>::clear()
+{
+    for (const auto &e : heap_) {
+        pos_[e.node] = -1;
+    }
+    heap_.clear();
+}
+
+template <int D, typename Key>
+void IndexedHeap<D, Key>::push(int node, Key key)
+{
+    assert(!contains(node));
+    heap_.push_back(Entry{key, node});
+    pos_[node] = size() - 1;
+    siftUp(size() - 1);
+}
+
+template <int D, typename Key>
+void IndexedHeap<D, Key>::decreaseKey(int node, Key key)
+{
+    assert(contains(node));
+    auto i = pos_[node];
+    assert(!(heap_[i].key < key));
+    heap_[i].key = key;
+    siftUp(i);
+}
+
+template <int D, typename Key>
+void IndexedHeap<D, Key>::update(int node, Key key)
+{
+    assert(contains(node));
+    auto i = pos_[node];
+    auto increased = heap_[i].key < key;
+    heap_[i].key = key;
+    if (increased) {
+        siftDown(i);
+    }
+    else {
+        siftUp(i);
+    }
+}
+
+template <int D, typename Key>
+int IndexedHeap<D, Key>::top() const
+{
+    assert(!empty());
+    return heap_[0].node;
+}
+
+template <int D, typename Key>
+Key IndexedHeap<D, Key>::topKey() const
+{
+    assert(!empty());
+    return heap_[0].key;
+}
+
+template <int D, typename Key>
+int IndexedHeap<D, Key>::pop()
+{
+    assert(!empty());
+    auto node = heap_[0].node;
+    pos_[node] = -1;
+
+    auto last = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty()) {
+        place(0, last);
+        siftDown(0);
+    }
+    return node;
+}
+
+template <int D, typename Key>
+void IndexedHeap<D, Key>::remove(int node)
+{
+    assert(contains(node));
+    auto i = pos_[node];
+    pos_[node] = -1;
+
+    // Fill the hole with the last entry, which could belong either above or
+    // below it.
+    auto last = heap_.back();
+    heap_.pop_back();
+    if (i < size()) {
+        place(i, last);
+        siftUp(i);
+        siftDown(pos_[last.node]);
+    }
+}
+
+template <int D, typename Key>
+void IndexedHeap<D, Key>::place(int i, const Entry &e)
+{
+    heap_[i] = e;
+    pos_[e.node] = i;
+}
+
+template <int D, typename Key>
+void IndexedHeap<D, Key>::siftUp(int i)
+{
+    auto e = heap_[i];
+    while (i > 0) {
+        auto parent = (i - 1) / D;
+        if (!(e.key < heap_[parent].key)) break;
+        place(i, heap_[parent]);
+        i = parent;
+    }
+    place(i, e);
+}
+
+template <int D, typename Key>
+void IndexedHeap<D, Key>::siftDown(int i)
+{
+    auto e = heap_[i];
+    auto n = size();
+    for (;;) {
+        auto first = i * D + 1;
+        if (first >= n) break;
+
+        // Find the child with the smallest key.
+        auto best = first;
+        auto last = std::min(first + D, n);
+        for (auto c = first + 1; c < last; ++c) {
+            if (heap_[c].key < heap_[best].key) {
+                best = c;
+            }
+        }
+        if (!(heap_[best].key < e.key)) break;
+        place(i, heap_[best]);
+        i = best;
+    }
+    place(i, e);
+}
+
+#endif
@@ -0,0 +1,472 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#include "JumpPathfinder.h"
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    // Largest value a table entry holds.  It means "this many or more".
+    const int maxEntry = 0xffff;
+
+    // Axial coordinates make straight lines easy: each step in a given
+    // direction adds the same (q,r) offset no matter which column we're in.
+    struct Axial
+    {
+        int q;
+        int r;
+    };
+
+    const int axialDq[] = {0, 1, 1, 0, -1, -1};
+    const int axialDr[] = {-1, -1, 0, 1, 1, 0};
+
+    Axial axial(const Point &hex)
+    {
+        return {hex.first, hex.second - (hex.first - (hex.first & 1)) / 2};
+    }
+
+    Point offset(int q, int r)
+    {
+        return {q, r + (q - (q & 1)) / 2};
+    }
+
+    Dir turn(Dir d, int sixths)
+    {
+        return static_cast<Dir>((static_cast<int>(d) + sixths + 6) % 6);
+    }
+
+    // N-S is axis 0, NE-SW is axis 1, SE-NW is axis 2.
+    int axis(Dir d)
+    {
+        return static_cast<int>(d) % 3;
+    }
+
+    // Solve delta = i*u + j*v where u and v are adjacent directions.
+    void decompose(const Axial &delta, Dir u, Dir v, int &i, int &j)
+    {
+        auto ui = static_cast<int>(u);
+        auto vi = static_cast<int>(v);
+
+        // The determinant is always 1 or -1, so multiplying by it is the same
+        // as dividing, only faster.
+        auto det = axialDq[ui] * axialDr[vi] - axialDr[ui] * axialDq[vi];
+        i = (delta.q * axialDr[vi] - delta.r * axialDq[vi]) * det;
+        j = (axialDq[ui] * delta.r - axialDr[ui] * delta.q) * det;
+    }
+}
+
+JumpPathfinder::JumpPathfinder(const HexGrid &grid,
+                               std::function<bool (int)> walkable,
+                               std::function<int (int)> group)
+    : grid_(grid),
+    open_(grid.size()),
+    group_(),
+    wall_(grid.size() * 6),
+    stop_(grid.size() * 6)
+{
+    for (int i = 0; i < grid_.size(); ++i) {
+        open_[i] = walkable(i);
+    }
+    if (group) {
+        group_.resize(grid_.size());
+        for (int i = 0; i < grid_.size(); ++i) {
+            group_[i] = group(i);
+        }
+    }
+
+    buildTables();
+}
+
+std::vector<int> JumpPathfinder::getPath(int aSrc, int aDest,
+                                         PathScratch &scratch) const
+{
+    NoStats stats;
+    return search(aSrc, aDest, scratch, stats);
+}
+
+std::vector<int> JumpPathfinder::getPath(int aSrc, int aDest,
+                                         PathScratch &scratch,
+                                         PathStats &stats) const
+{
+    return search(aSrc, aDest, scratch, stats);
+}
+
+int JumpPathfinder::size() const
+{
+    return grid_.size();
+}
+
+void JumpPathfinder::add(int aIndex)
+{
+    setOpen(aIndex, true);
+}
+
+void JumpPathfinder::remove(int aIndex)
+{
+    setOpen(aIndex, false);
+}
+
+template <typename Stats>
+std::vector<int> JumpPathfinder::search(int aSrc, int aDest,
+                                        PathScratch &scratch,
+                                        Stats &stats) const
+{
+    SearchTimer<Stats> timer(stats);
+    assert(scratch.size() >= grid_.size());
+    if (aSrc == aDest) return {aSrc};
+    if (!open(aSrc, aDest)) return {};
+
+    scratch.reset();
+    auto &openList = scratch.open_;
+    DenseNodeIndex index(scratch);
+    auto hDest = grid_.hexFromAry(aDest);
+    bool found = false;
+
+    scratch.add(aSrc, -1, 0);
+    openList.push(aSrc, 0);
+    stats.push(openList.size());
+
+    while (!openList.empty()) {
+        auto cur = openList.pop();
+        stats.pop();
+        if (cur == aDest) {
+            found = true;
+            break;
+        }
+
+        scratch.visited_[cur] = 1;
+        stats.expand();
+        auto curCost = scratch.costSoFar_[cur];
+
+        // The start expands in every direction.  Jump points keep going the
+        // way they were headed, plus any turns the rules allow.
+        Dir dirs[6];
+        int numDirs = 0;
+        auto prev = scratch.prev_[cur];
+        if (prev == -1) {
+            for (auto d : Dir()) {
+                dirs[numDirs++] = d;
+            }
+        }
+        else {
+            auto d = lineDir(prev, cur);
+            dirs[numDirs++] = d;
+            for (int s : {-1, 1}) {
+                auto t = turn(d, s);
+                if (axis(t) > axis(d) ||
+                    (!open(cur, turn(d, 2 * s)) && open(cur, t))) {
+                    dirs[numDirs++] = t;
+                }
+            }
+        }
+
+        for (int k = 0; k < numDirs; ++k) {
+            auto jp = jump(cur, dirs[k], aDest, hDest);
+            if (jp == -1) continue;
+            stats.generate();
+
+            auto newCost = curCost + lineDist(cur, jp);
+            auto estimate = hexDist(grid_.hexFromAry(jp), hDest);
+            if (index.find(jp) != -1) {
+                if (scratch.visited_[jp] ||
+                    newCost >= scratch.costSoFar_[jp]) {
+                    continue;
+                }
+                scratch.prev_[jp] = cur;
+                scratch.costSoFar_[jp] = newCost;
+                openList.decreaseKey(jp, newCost + estimate);
+                stats.decreaseKey();
+            }
+            else {
+                scratch.add(jp, cur, newCost);
+                openList.push(jp, newCost + estimate);
+                stats.push(openList.size());
+            }
+        }
+    }
+
+    if (!found) {
+        return {};
+    }
+
+    // Fill in the hexes between each pair of jump points.
+    std::vector<int> path = {aDest};
+    for (auto a = aDest; scratch.prev_[a] != -1; a = scratch.prev_[a]) {
+        auto prev = scratch.prev_[a];
+        auto back = turn(lineDir(prev, a), 3);
+        for (auto h = grid_.aryGetNeighbor(a, back); h != prev;
+             h = grid_.aryGetNeighbor(h, back)) {
+            path.push_back(h);
+        }
+        path.push_back(prev);
+    }
+    reverse(std::begin(path), std::end(path));
+    return path;
+}
+
+bool JumpPathfinder::open(int aFrom, int aTo) const
+{
+    return aTo != -1 && open_[aTo] &&
+        (group_.empty() || group_[aTo] == group_[aFrom]);
+}
+
+bool JumpPathfinder::open(int aFrom, Dir d) const
+{
+    return open(aFrom, grid_.aryGetNeighbor(aFrom, d));
+}
+
+bool JumpPathfinder::hasForcedNeighbor(int aIndex, Dir d) const
+{
+    // A turn onto a lower-ranked axis is needed if the hex we would have
+    // visited by making that move first is blocked.
+    for (int s : {-1, 1}) {
+        auto t = turn(d, s);
+        if (axis(t) < axis(d) && !open(aIndex, turn(d, 2 * s)) &&
+            open(aIndex, t)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int JumpPathfinder::walk(int aIndex, Dir d, int steps) const
+{
+    auto pos = axial(grid_.hexFromAry(aIndex));
+    auto di = static_cast<int>(d);
+    return grid_.aryFromHex(offset(pos.q + steps * axialDq[di],
+                                   pos.r + steps * axialDr[di]));
+}
+
+int JumpPathfinder::wallDist(int aIndex, Dir d) const
+{
+    return tableDist(wall_, aIndex, d);
+}
+
+int JumpPathfinder::stopDist(int aIndex, Dir d) const
+{
+    return tableDist(stop_, aIndex, d);
+}
+
+int JumpPathfinder::tableDist(const std::vector<Uint16> &table, int aIndex,
+                              Dir d) const
+{
+    // A capped entry is at least maxEntry, so every hex up to one short of
+    // that is open and isn't a jump point.  The rest of the distance is
+    // whatever the table says from there.
+    int dist = 0;
+    for (;;) {
+        int entry = table[aIndex * 6 + static_cast<int>(d)];
+        if (entry < maxEntry) return dist + entry;
+        dist += maxEntry - 1;
+        aIndex = walk(aIndex, d, maxEntry - 1);
+    }
+}
+
+int JumpPathfinder::wallValue(int aIndex, Dir d) const
+{
+    auto next = grid_.aryGetNeighbor(aIndex, d);
+    return open(aIndex, next) ? 1 + wallDist(next, d) : 0;
+}
+
+int JumpPathfinder::stopValue(int aIndex, Dir d) const
+{
+    auto next = grid_.aryGetNeighbor(aIndex, d);
+    if (!open(aIndex, next)) return 0;
+
+    // Jump points along each axis depend on those of the higher axes.
+    auto isJump = hasForcedNeighbor(next, d);
+    if (axis(d) == 0) {
+        isJump = isJump || stopDist(next, turn(d, 1)) > 0 ||
+            stopDist(next, turn(d, -1)) > 0;
+    }
+    else if (axis(d) == 1) {
+        isJump = isJump || stopDist(next, turn(d, 1)) > 0;
+    }
+
+    if (isJump) return 1;
+    auto nextStop = stopDist(next, d);
+    return nextStop > 0 ? nextStop + 1 : 0;
+}
+
+void JumpPathfinder::fillTable(std::vector<Uint16> &table, Dir d,
+                               const std::function<int (int)> &value)
+{
+    std::vector<char> done(grid_.size(), 0);
+    std::vector<int> line;
+
+    for (int i = 0; i < grid_.size(); ++i) {
+        if (done[i]) continue;
+
+        // Follow the line until we reach a hex we've already done or one
+        // whose value doesn't depend on the next hex.  Then work backward.
+        line.clear();
+        auto cur = i;
+        for (;;) {
+            line.push_back(cur);
+            auto next = grid_.aryGetNeighbor(cur, d);
+            if (!open(cur, next) || done[next]) break;
+            cur = next;
+        }
+
+        for (auto iter = line.rbegin(); iter != line.rend(); ++iter) {
+            table[*iter * 6 + static_cast<int>(d)] =
+                std::min(value(*iter), maxEntry);
+            done[*iter] = 1;
+        }
+    }
+}
+
+void JumpPathfinder::buildTables()
+{
+    for (auto d : Dir()) {
+        fillTable(wall_, d, [=] (int a) { return wallValue(a, d); });
+    }
+    for (int ax = 2; ax >= 0; --ax) {
+        for (auto d : Dir()) {
+            if (axis(d) != ax) continue;
+            fillTable(stop_, d, [=] (int a) { return stopValue(a, d); });
+        }
+    }
+}
+
+void JumpPathfinder::refill(std::vector<Uint16> &table, int aIndex, Dir d,
+                            const std::function<int (int)> &value,
+                            std::vector<int> &changed)
+{
+    auto back = turn(d, 3);
+    for (auto a = aIndex; a != -1; a = grid_.aryGetNeighbor(a, back)) {
+        auto &entry = table[a * 6 + static_cast<int>(d)];
+        auto newEntry = std::min(value(a), maxEntry);
+        if (newEntry == entry) return;
+        entry = newEntry;
+        changed.push_back(a);
+    }
+}
+
+void JumpPathfinder::setOpen(int aIndex, bool open)
+{
+    if (open_[aIndex] == open) return;
+    open_[aIndex] = open;
+
+    // An entry reads whether the next hex along the line is open, and for
+    // jump points, whether the hexes around that one are.  So the entries
+    // that change first are for the hexes just before this one and its
+    // neighbors.
+    std::vector<int> hexes = {aIndex};
+    for (auto d : Dir()) {
+        auto n = grid_.aryGetNeighbor(aIndex, d);
+        if (n != -1) hexes.push_back(n);
+    }
+
+    std::vector<int> changed;
+    auto refillBefore = [&] (std::vector<Uint16> &table, Dir d,
+                             const std::function<int (int)> &value) {
+        for (auto h : hexes) {
+            auto prev = grid_.aryGetNeighbor(h, turn(d, 3));
+            if (prev != -1) {
+                refill(table, prev, d, value, changed);
+            }
+        }
+    };
+
+    for (auto d : Dir()) {
+        refillBefore(wall_, d, [=] (int a) { return wallValue(a, d); });
+    }
+    changed.clear();
+
+    // Jump points that move along a higher axis can make or unmake them on
+    // the lower axes too, so those hexes get another look.
+    for (int ax = 2; ax >= 0; --ax) {
+        for (auto d : Dir()) {
+            if (axis(d) != ax) continue;
+            refillBefore(stop_, d, [=] (int a) { return stopValue(a, d); });
+        }
+        hexes.insert(std::end(hexes), std::begin(changed),
+                     std::end(changed));
+        changed.clear();
+    }
+}
+
+int JumpPathfinder::jump(int aIndex, Dir d, int aDest,
+                         const Point &hDest) const
+{
+    auto stop = stopDist(aIndex, d);
+    if (axis(d) != 0) {
+        return jumpOrGoal(aIndex, d, hDest, stop);
+    }
+
+    // N-S lines have to check each hex for a way to turn toward the goal.
+    auto limit = (stop > 0) ? stop : wallDist(aIndex, d);
+    auto cur = aIndex;
+    for (int i = 1; i <= limit; ++i) {
+        cur = grid_.aryGetNeighbor(cur, d);
+        if (cur == aDest || i == stop ||
+            jumpOrGoal(cur, turn(d, 1), hDest, 0) != -1 ||
+            jumpOrGoal(cur, turn(d, -1), hDest, 0) != -1) {
+            return cur;
+        }
+    }
+    return -1;
+}
+
+int JumpPathfinder::jumpOrGoal(int aIndex, Dir d, const Point &hDest,
+                               int stop) const
+{
+    auto from = axial(grid_.hexFromAry(aIndex));
+    auto to = axial(hDest);
+    Axial delta = {to.q - from.q, to.r - from.r};
+
+    // How many steps along this line before we can reach the goal?  Along
+    // NE-SW lines, that includes turning onto an SE-NW line.
+    int steps = 0;
+    int i = 0;
+    int j = 0;
+    decompose(delta, d, turn(d, 1), i, j);
+    if (i >= 1 && j >= 0 && i <= wallDist(aIndex, d)) {
+        if (j == 0) {
+            steps = i;
+        }
+        else if (axis(d) == 1) {
+            auto turnAt = walk(aIndex, d, i);
+            if (j <= wallDist(turnAt, turn(d, 1))) {
+                steps = i;
+            }
+        }
+    }
+
+    if (steps > 0 && (stop == 0 || steps <= stop)) {
+        return walk(aIndex, d, steps);
+    }
+    if (stop > 0) {
+        return walk(aIndex, d, stop);
+    }
+    return -1;
+}
+
+Dir JumpPathfinder::lineDir(int aFrom, int aTo) const
+{
+    auto from = axial(grid_.hexFromAry(aFrom));
+    auto to = axial(grid_.hexFromAry(aTo));
+    auto dq = to.q - from.q;
+    auto dr = to.r - from.r;
+
+    if (dq == 0) return (dr < 0) ? Dir::N : Dir::S;
+    if (dr == 0) return (dq > 0) ? Dir::SE : Dir::NW;
+    assert(dq == -dr);
+    return (dq > 0) ? Dir::NE : Dir::SW;
+}
+
+int JumpPathfinder::lineDist(int aFrom, int aTo) const
+{
+    return hexDist(grid_.hexFromAry(aFrom), grid_.hexFromAry(aTo));
+}
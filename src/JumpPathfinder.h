@@ -0,0 +1,126 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+ 
+    See the COPYING.txt file for more details.
+*/
+#ifndef JUMP_PATHFINDER_H
+#define JUMP_PATHFINDER_H
+
+#include "BasicPathfinder.h"
+#include "HexGrid.h"
+#include "PathStats.h"
+#include "hex_utils.h"
+#include <functional>
+#include <vector>
+
+// Jump Point Search adapted to the hex grid, for maps where every step costs
+// the same.  Returns paths of the same length as A*, but instead of adding
+// every hex to the open list it skips along straight lines and only stops at
+// hexes where the path might need to turn.
+//
+// How it works: a shortest path on an open hex grid only ever moves in two
+// adjacent directions, and those moves can happen in any order.  We rank the
+// three axes of the grid (N-S first, NE-SW second, SE-NW last) and only
+// consider the order that makes lower-ranked moves first.  Moving along an
+// axis, you may continue straight or turn 60 degrees onto a higher-ranked
+// axis.  Turning onto a lower-ranked axis is only allowed when an obstacle
+// blocked the preferred ordering (a "forced" neighbor).  A turn of 120
+// degrees or more never helps.
+//
+// Scanning for jump points is the expensive part, so the distance from each
+// hex to the next wall and to the next jump point in every direction is
+// computed up front (as in JPS+).  When a hex opens up or gets blocked, only
+// the entries along the lines through it and its neighbors are recomputed,
+// out to where they stop changing.  Each entry is 16 bits.  Longer distances
+// are capped, and reading a capped entry walks ahead to the end of what it
+// covers and reads on from there.
+class JumpPathfinder
+{
+public:
+    // Paths may only use hexes for which walkable() returns true.  If a group
+    // function is given, paths also stay within one group (a region, say),
+    // and hexes in other groups count as obstacles.
+    JumpPathfinder(const HexGrid &grid, std::function<bool (int)> walkable,
+                   std::function<int (int)> group = nullptr);
+
+    // Return the shortest path between two hexes, including every hex along
+    // the way.  Return an empty list if there isn't one.  The scratch space
+    // must be sized for the grid.
+    std::vector<int> getPath(int aSrc, int aDest, PathScratch &scratch) const;
+
+    // Same as above, but add counts of the work done to the given stats.
+    // Only jump points count as expanded or generated.
+    std::vector<int> getPath(int aSrc, int aDest, PathScratch &scratch,
+                             PathStats &stats) const;
+
+    // Number of hexes on the grid, for sizing scratch space.
+    int size() const;
+
+    // Call these after a hex becomes walkable, or stops being walkable.
+    void add(int aIndex);
+    void remove(int aIndex);
+
+private:
+    template <typename Stats>
+    std::vector<int> search(int aSrc, int aDest, PathScratch &scratch,
+                            Stats &stats) const;
+
+    bool open(int aFrom, int aTo) const;  // can aFrom's group stand on aTo?
+    bool open(int aFrom, Dir d) const;
+    bool hasForcedNeighbor(int aIndex, Dir d) const;
+
+    // Hex some number of steps away in a straight line.
+    int walk(int aIndex, Dir d, int steps) const;
+
+    // Number of open hexes in a straight line before the next obstacle.
+    int wallDist(int aIndex, Dir d) const;
+
+    // Number of steps to the next jump point that doesn't depend on where the
+    // goal is, or 0 if we'd hit a wall first.
+    int stopDist(int aIndex, Dir d) const;
+
+    // Read a distance from one of the tables, following capped entries.
+    int tableDist(const std::vector<Uint16> &table, int aIndex, Dir d) const;
+
+    // Table entries for one hex, computed from the entries for the next hex
+    // along the line.
+    int wallValue(int aIndex, Dir d) const;
+    int stopValue(int aIndex, Dir d) const;
+
+    // Fill in one of the tables for every hex in one direction.
+    void fillTable(std::vector<Uint16> &table, Dir d,
+                   const std::function<int (int)> &value);
+    void buildTables();
+
+    // Recompute the entry for one hex, then for the hexes before it along
+    // the line for as long as their entries change.  List each hex that
+    // changed.
+    void refill(std::vector<Uint16> &table, int aIndex, Dir d,
+                const std::function<int (int)> &value,
+                std::vector<int> &changed);
+    void setOpen(int aIndex, bool open);
+
+    // Find the next jump point in the given direction, or -1 if there isn't
+    // one.  Only the NE-SW and SE-NW results are precomputed, because jump
+    // points along N-S lines depend on the goal in too many ways.
+    int jump(int aIndex, Dir d, int aDest, const Point &hDest) const;
+    int jumpOrGoal(int aIndex, Dir d, const Point &hDest, int stop) const;
+
+    Dir lineDir(int aFrom, int aTo) const;
+    int lineDist(int aFrom, int aTo) const;
+
+    HexGrid grid_;
+    std::vector<char> open_;
+    std::vector<int> group_;
+    std::vector<Uint16> wall_;  // 6 entries per hex, one per Dir
+    std::vector<Uint16> stop_;
+};
+
+#endif
@@ -0,0 +1,192 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#include "Landmarks.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+const Uint16 Landmarks::unreachable;
+const Uint16 Landmarks::tooFar;
+
+Landmarks::Landmarks(const HexGrid &grid, std::function<bool (int)> walkable,
+                     int numLandmarks)
+    : grid_(grid),
+    open_(grid.size()),
+    numSlots_(numLandmarks),
+    landmarks_(),
+    dist_(grid.size() * numLandmarks, unreachable),
+    queue_()
+{
+    assert(numLandmarks > 0);
+    for (int a = 0; a < grid_.size(); ++a) {
+        open_[a] = walkable(a);
+    }
+
+    // Landmarks only help within the area they can reach, so put them all in
+    // the biggest one.
+    auto start = -1;
+    auto startSize = 0u;
+    std::vector<char> visited(grid_.size(), 0);
+    for (int a = 0; a < grid_.size(); ++a) {
+        if (visited[a] || !walkable(a)) continue;
+
+        visited[a] = 1;
+        queue_.assign(1, a);
+        for (auto i = 0u; i < queue_.size(); ++i) {
+            for (auto dir : Dir()) {
+                auto n = grid_.aryGetNeighbor(queue_[i], dir);
+                if (n != -1 && !visited[n] && walkable(n)) {
+                    visited[n] = 1;
+                    queue_.push_back(n);
+                }
+            }
+        }
+        if (queue_.size() > startSize) {
+            start = a;
+            startSize = queue_.size();
+        }
+    }
+    if (start == -1) return;
+
+    // Start with the hex farthest from some arbitrary hex in that area.  Each
+    // landmark after that is the hex farthest from all the others.
+    measure(start, 0, walkable);
+    std::vector<int> nearest(grid_.size(), 0);
+    for (int a = 0; a < grid_.size(); ++a) {
+        if (dist_[a * numSlots_] != unreachable) {
+            nearest[a] = dist_[a * numSlots_];
+        }
+    }
+
+    for (int i = 0; i < numSlots_; ++i) {
+        auto next = max_element(std::begin(nearest), std::end(nearest)) -
+            std::begin(nearest);
+        if (nearest[next] == 0) break;  // every hex we can reach is a landmark
+
+        landmarks_.push_back(next);
+        measure(next, i, walkable);
+        for (int a = 0; a < grid_.size(); ++a) {
+            auto d = dist_[a * numSlots_ + i];
+            if (d != unreachable && (i == 0 || d < nearest[a])) {
+                nearest[a] = d;
+            }
+        }
+    }
+}
+
+int Landmarks::size() const
+{
+    return landmarks_.size();
+}
+
+int Landmarks::landmark(int i) const
+{
+    assert(i >= 0 && i < size());
+    return landmarks_[i];
+}
+
+int Landmarks::distance(int i, int aIndex) const
+{
+    assert(i >= 0 && i < size());
+    assert(aIndex >= 0 && aIndex < grid_.size());
+    auto d = dist_[aIndex * numSlots_ + i];
+    return d >= tooFar ? -1 : d;
+}
+
+int Landmarks::estimate(int aFrom, int aTo) const
+{
+    int best = hexDist(grid_.hexFromAry(aFrom), grid_.hexFromAry(aTo));
+    auto from = &dist_[aFrom * numSlots_];
+    auto to = &dist_[aTo * numSlots_];
+    for (int i = 0; i < numSlots_; ++i) {
+        if (from[i] >= tooFar || to[i] >= tooFar) continue;
+        best = std::max(best, std::abs(from[i] - to[i]));
+    }
+    return best;
+}
+
+std::function<int (int)> Landmarks::estimateTo(int aGoal) const
+{
+    return [this, aGoal] (int aIndex) { return estimate(aIndex, aGoal); };
+}
+
+void Landmarks::add(int aIndex)
+{
+    assert(aIndex >= 0 && aIndex < grid_.size());
+    if (open_[aIndex]) return;
+    open_[aIndex] = 1;
+
+    for (int i = 0; i < size(); ++i) {
+        // The new hex is one step past its nearest neighbor.  From there,
+        // breadth-first search out to every hex that's now closer.
+        auto &distHere = dist_[aIndex * numSlots_ + i];
+        for (auto dir : Dir()) {
+            auto n = grid_.aryGetNeighbor(aIndex, dir);
+            if (n == -1 || !open_[n]) continue;
+            auto distN = dist_[n * numSlots_ + i];
+            auto viaN = std::min(distN + 1, +tooFar);
+            if (distN != unreachable && viaN < distHere) {
+                distHere = viaN;
+            }
+        }
+        if (distHere == unreachable) continue;
+
+        queue_.assign(1, aIndex);
+        for (auto j = 0u; j < queue_.size(); ++j) {
+            auto cur = queue_[j];
+            auto next = std::min(dist_[cur * numSlots_ + i] + 1, +tooFar);
+
+            for (auto dir : Dir()) {
+                auto n = grid_.aryGetNeighbor(cur, dir);
+                if (n == -1 || !open_[n] || dist_[n * numSlots_ + i] <= next)
+                {
+                    continue;
+                }
+                dist_[n * numSlots_ + i] = next;
+                queue_.push_back(n);
+            }
+        }
+    }
+}
+
+void Landmarks::remove(int aIndex)
+{
+    assert(aIndex >= 0 && aIndex < grid_.size());
+    open_[aIndex] = 0;
+}
+
+void Landmarks::measure(int aSrc, int slot,
+                        const std::function<bool (int)> &walkable)
+{
+    for (int a = 0; a < grid_.size(); ++a) {
+        dist_[a * numSlots_ + slot] = unreachable;
+    }
+
+    dist_[aSrc * numSlots_ + slot] = 0;
+    queue_.assign(1, aSrc);
+    for (auto i = 0u; i < queue_.size(); ++i) {
+        auto cur = queue_[i];
+        auto next = std::min(dist_[cur * numSlots_ + slot] + 1, +tooFar);
+
+        for (auto dir : Dir()) {
+            auto n = grid_.aryGetNeighbor(cur, dir);
+            if (n == -1 || dist_[n * numSlots_ + slot] != unreachable ||
+                !walkable(n))
+            {
+                continue;
+            }
+            dist_[n * numSlots_ + slot] = next;
+            queue_.push_back(n);
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include "HexGrid.h"
+#include "hex_utils.h"
+#include <functional>
+#include <vector>
+
+// Distances from a few landmark hexes to every hex on the map, for a better
+// A* estimate than straight-line distance (the ALT heuristic).  If landmark L
+// is d1 steps from hex a and d2 steps from hex b, then by the triangle
+// inequality, no path from a to b can be shorter than |d1 - d2|.  Unlike
+// hexDist(), that bound knows about obstacles.
+//
+// Every step costs 1.  The landmarks all go in the largest connected area;
+// elsewhere the estimate is just hexDist().  The bound still holds for
+// searches that are only allowed to use some of the hexes, since their paths
+// can only be longer.  That's also why blocking a hex leaves the distances
+// alone.  Opening one shortens whatever distances it can.
+class Landmarks
+{
+public:
+    // Pick the landmarks spread out as far from each other as possible.
+    // Each one costs 16 bits per hex.
+    Landmarks(const HexGrid &grid, std::function<bool (int)> walkable,
+              int numLandmarks);
+
+    int size() const;
+    int landmark(int i) const;
+
+    // Number of steps between landmark i and the given hex, or -1 if you
+    // can't get there or it's too far to store.
+    int distance(int i, int aIndex) const;
+
+    // Lower bound on the number of steps between two hexes, never less than
+    // hexDist().
+    int estimate(int aFrom, int aTo) const;
+
+    // Estimate function for a Pathfinder headed for the given hex.  Good for
+    // as long as this object is.
+    std::function<int (int)> estimateTo(int aGoal) const;
+
+    // Call these after a hex becomes walkable, or stops being walkable.
+    void add(int aIndex);
+    void remove(int aIndex);
+
+private:
+    // Distances too big for 16 bits are stored as tooFar, and the estimate
+    // doesn't use them.
+    static const Uint16 unreachable = 0xffff;
+    static const Uint16 tooFar = 0xfffe;
+
+    // Breadth-first search out from a hex, filling in the distance to each
+    // hex for the given landmark slot.
+    void measure(int aSrc, int slot, const std::function<bool (int)> &walkable);
+
+    HexGrid grid_;
+    std::vector<char> open_;  // hexes the distances can go through
+    int numSlots_;
+    std::vector<int> landmarks_;
+    std::vector<Uint16> dist_;  // all the landmarks for hex 0, then hex 1, ...
+    std::vector<int> queue_;
+};
+
+#endif
@@ -44,8 +44,8 @@ SDL_Rect Minimap::drawBoundingBox()
 {
     Sint16 sx = displayArea_.x;
     Sint16 sy = displayArea_.y;
-    Sint16 mapX = 0;
-    Sint16 mapY = 0;
+    int mapX = 0;
+    int mapY = 0;
     std::tie(mapX, mapY) = map_.mDrawnAt();
     const auto &visibleArea = map_.getDisplayArea();
 
@@ -0,0 +1,97 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#ifndef NEIGHBOR_LIST_H
+#define NEIGHBOR_LIST_H
+
+#include <cassert>
+#include <vector>
+
+// List of neighbors of a node.  Hex grids never have more than six, and those
+// fit without touching the heap, so it's cheap to return one by value.  Larger
+// nodes spill over into a vector.
+class NeighborList
+{
+public:
+    static const int capacity = 6;
+
+    NeighborList();
+
+    void clear();
+    void push_back(int node);
+    int size() const;
+    bool empty() const;
+    int operator[](int i) const;
+    const int * begin() const;
+    const int * end() const;
+
+private:
+    int fixed_[capacity];
+    std::vector<int> overflow_;
+    int size_;
+};
+
+
+inline NeighborList::NeighborList()
+    : fixed_(),
+    overflow_(),
+    size_(0)
+{
+}
+
+inline void NeighborList::clear()
+{
+    size_ = 0;
+    overflow_.clear();
+}
+
+inline void NeighborList::push_back(int node)
+{
+    if (size_ < capacity) {
+        fixed_[size_++] = node;
+        return;
+    }
+
+    if (size_ == capacity) {
+        overflow_.assign(fixed_, fixed_ + capacity);
+    }
+    overflow_.push_back(node);
+    ++size_;
+}
+
+inline int NeighborList::size() const
+{
+    return size_;
+}
+
+inline bool NeighborList::empty() const
+{
+    return size_ == 0;
+}
+
+inline int NeighborList::operator[](int i) const
+{
+    assert(i >= 0 && i < size_);
+    return begin()[i];
+}
+
+inline const int * NeighborList::begin() const
+{
+    return size_ <= capacity ? fixed_ : overflow_.data();
+}
+
+inline const int * NeighborList::end() const
+{
+    return begin() + size_;
+}
+
+#endif
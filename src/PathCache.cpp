@@ -0,0 +1,103 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#include "PathCache.h"
+#include <cassert>
+
+PathCache::PathCache(int capacity)
+    : entries_(),
+    index_(),
+    capacity_(capacity),
+    version_(0),
+    hits_(0),
+    misses_(0)
+{
+    assert(capacity_ > 0);
+}
+
+const std::vector<int> * PathCache::find(int aSrc, int aDest,
+                                         unsigned version)
+{
+    checkVersion(version);
+
+    auto iter = index_.find(makeKey(aSrc, aDest));
+    if (iter == index_.end()) {
+        ++misses_;
+        return nullptr;
+    }
+
+    // Move to the front of the line.
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, iter->second);
+    return &entries_.front().path;
+}
+
+void PathCache::insert(int aSrc, int aDest, unsigned version,
+                       std::vector<int> path)
+{
+    checkVersion(version);
+
+    auto key = makeKey(aSrc, aDest);
+    auto iter = index_.find(key);
+    if (iter != index_.end()) {
+        iter->second->path = std::move(path);
+        entries_.splice(entries_.begin(), entries_, iter->second);
+        return;
+    }
+
+    if (size() == capacity_) {
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+    entries_.push_front(Entry{key, std::move(path)});
+    index_.emplace(key, entries_.begin());
+}
+
+void PathCache::clear()
+{
+    entries_.clear();
+    index_.clear();
+}
+
+int PathCache::size() const
+{
+    return index_.size();
+}
+
+int PathCache::capacity() const
+{
+    return capacity_;
+}
+
+int PathCache::hits() const
+{
+    return hits_;
+}
+
+int PathCache::misses() const
+{
+    return misses_;
+}
+
+PathCache::Key PathCache::makeKey(int aSrc, int aDest)
+{
+    return (static_cast<Key>(static_cast<std::uint32_t>(aSrc)) << 32) |
+        static_cast<std::uint32_t>(aDest);
+}
+
+void PathCache::checkVersion(unsigned version)
+{
+    if (version != version_) {
+        clear();
+        version_ = version;
+    }
+}
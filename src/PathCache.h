@@ -0,0 +1,68 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+ 
+    See the COPYING.txt file for more details.
+*/
+#ifndef PATH_CACHE_H
+#define PATH_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// Remember the most recently used paths, keyed by source and destination.
+// When full, the path used least recently makes room for the new one.
+//
+// Every lookup carries the map version the caller is working with.  If it
+// doesn't match the version the cached paths were found on, they're all
+// thrown out.  Bump the version whenever anything a path depends on changes.
+class PathCache
+{
+public:
+    explicit PathCache(int capacity);
+
+    // Return the cached path, or nullptr if there isn't one.  The pointer is
+    // good until the next insert() or clear().
+    const std::vector<int> * find(int aSrc, int aDest, unsigned version);
+
+    void insert(int aSrc, int aDest, unsigned version, std::vector<int> path);
+    void clear();
+
+    int size() const;
+    int capacity() const;
+
+    // Lookup counts since the cache was created.
+    int hits() const;
+    int misses() const;
+
+private:
+    using Key = std::uint64_t;
+
+    struct Entry
+    {
+        Key key;
+        std::vector<int> path;
+    };
+
+    static Key makeKey(int aSrc, int aDest);
+
+    // Throw out everything if the map has changed.
+    void checkVersion(unsigned version);
+
+    std::list<Entry> entries_;  // most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator> index_;
+    int capacity_;
+    unsigned version_;
+    int hits_;
+    int misses_;
+};
+
+#endif
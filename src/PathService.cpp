@@ -0,0 +1,166 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#include "PathService.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+namespace
+{
+    // Workers claim this many queries at a time.  Large enough to keep them
+    // off the lock, small enough that a batch splits evenly across threads.
+    const int chunkSize = 8;
+}
+
+struct PathService::Batch
+{
+    std::shared_ptr<const JumpPathfinder> map;
+    std::vector<Query> queries;
+    Results results;
+    Callback done;
+    int next;  // first query not yet claimed, guarded by the service mutex
+    std::atomic<int> remaining;  // queries not yet finished
+
+    Batch(std::shared_ptr<const JumpPathfinder> m, std::vector<Query> q,
+          Callback c)
+        : map(std::move(m)),
+        queries(std::move(q)),
+        results(queries.size()),
+        done(std::move(c)),
+        next(0),
+        remaining(queries.size())
+    {
+    }
+};
+
+PathService::PathService(std::shared_ptr<const JumpPathfinder> map,
+                         int numThreads)
+    : map_(std::move(map)),
+    batches_(),
+    mutex_(),
+    wakeup_(),
+    stopping_(false),
+    workers_()
+{
+    assert(map_);
+    if (numThreads <= 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (int i = 0; i < numThreads; ++i) {
+        workers_.emplace_back(&PathService::workerLoop, this);
+    }
+}
+
+PathService::~PathService()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+    for (auto &t : workers_) {
+        t.join();
+    }
+}
+
+void PathService::setMap(std::shared_ptr<const JumpPathfinder> map)
+{
+    assert(map);
+    std::lock_guard<std::mutex> lock(mutex_);
+    map_ = std::move(map);
+}
+
+std::future<PathService::Results> PathService::submit(
+    std::vector<Query> queries)
+{
+    auto promise = std::make_shared<std::promise<Results>>();
+    auto future = promise->get_future();
+    submit(std::move(queries), [promise] (Results results) {
+        promise->set_value(std::move(results));
+    });
+    return future;
+}
+
+void PathService::submit(std::vector<Query> queries, Callback done)
+{
+    if (queries.empty()) {
+        done({});
+        return;
+    }
+
+    std::shared_ptr<const JumpPathfinder> map;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        map = map_;
+    }
+    enqueue(std::make_shared<Batch>(std::move(map), std::move(queries),
+                                    std::move(done)));
+}
+
+int PathService::numThreads() const
+{
+    return workers_.size();
+}
+
+void PathService::enqueue(std::shared_ptr<Batch> batch)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batches_.push_back(std::move(batch));
+    }
+    wakeup_.notify_all();
+}
+
+void PathService::workerLoop()
+{
+    PathScratch scratch;
+
+    for (;;) {
+        std::shared_ptr<Batch> batch;
+        int first = 0;
+        int last = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wakeup_.wait(lock, [this] {
+                return stopping_ || !batches_.empty();
+            });
+            if (batches_.empty()) return;
+
+            // Once the last chunk of a batch is claimed, nobody else needs
+            // to see it.  Whoever finishes the last query delivers results.
+            batch = batches_.front();
+            int numQueries = batch->queries.size();
+            first = batch->next;
+            last = std::min(first + chunkSize, numQueries);
+            batch->next = last;
+            if (last == numQueries) {
+                batches_.pop_front();
+            }
+        }
+
+        const auto &map = *batch->map;
+        if (scratch.size() < map.size()) {
+            scratch.resize(map.size());
+        }
+        for (int i = first; i < last; ++i) {
+            const auto &q = batch->queries[i];
+            batch->results[i] = map.getPath(q.first, q.second, scratch);
+        }
+
+        auto count = last - first;
+        if (batch->remaining.fetch_sub(count) == count) {
+            batch->done(std::move(batch->results));
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+ 
+    See the COPYING.txt file for more details.
+*/
+#ifndef PATH_SERVICE_H
+#define PATH_SERVICE_H
+
+#include "JumpPathfinder.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Answer batches of path queries on a fixed pool of worker threads.
+//
+// Each batch runs against the map snapshot that was current when it was
+// submitted.  A snapshot is a JumpPathfinder, which never changes after it's
+// built, so the workers can share it without locking.  To change the map,
+// build a new snapshot and call setMap(); batches already submitted keep the
+// old one.
+//
+// Each worker has its own PathScratch, so searches don't allocate once the
+// workers have warmed up.
+class PathService
+{
+public:
+    using Query = std::pair<int, int>;  // source and destination hexes
+    using Results = std::vector<std::vector<int>>;
+    using Callback = std::function<void (Results)>;
+
+    // Start the worker threads.  Default is one per core.
+    explicit PathService(std::shared_ptr<const JumpPathfinder> map,
+                         int numThreads = 0);
+
+    // Finish all submitted batches, then stop the workers.
+    ~PathService();
+
+    PathService(const PathService &) = delete;
+    PathService & operator=(const PathService &) = delete;
+
+    // Replace the map used for future batches.
+    void setMap(std::shared_ptr<const JumpPathfinder> map);
+
+    // Queue up a batch of queries.  Results come back in the same order as
+    // the queries, with an empty path wherever there isn't one.  The
+    // callback runs on whichever worker finishes the batch.
+    std::future<Results> submit(std::vector<Query> queries);
+    void submit(std::vector<Query> queries, Callback done);
+
+    int numThreads() const;
+
+private:
+    struct Batch;
+
+    void enqueue(std::shared_ptr<Batch> batch);
+    void workerLoop();
+
+    std::shared_ptr<const JumpPathfinder> map_;
+    std::deque<std::shared_ptr<Batch>> batches_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool stopping_;
+    std::vector<std::thread> workers_;
+};
+
+#endif
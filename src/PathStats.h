@@ -0,0 +1,148 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+ 
+    See the COPYING.txt file for more details.
+*/
+#ifndef PATH_STATS_H
+#define PATH_STATS_H
+
+#include <algorithm>
+#include <chrono>
+
+// Counters describing how much work a search did.  Pathfinders have overloads
+// that take one of these.  The overloads that don't use NoStats instead,
+// whose functions do nothing, so the counting compiles away and the search
+// loop pays nothing for it.
+struct PathStats
+{
+    int searches;      // number of searches added together
+    int expanded;      // nodes whose neighbors were examined
+    int generated;     // neighbors examined
+    int pushes;        // open list operations
+    int pops;
+    int decreaseKeys;
+    int peakOpen;      // largest the open list got
+    double elapsed_ms;
+
+    PathStats();
+
+    void expand();
+    void generate();
+    void push(int openSize);
+    void pop();
+    void decreaseKey();
+
+    // Combine the counts from another search.  Peak open list size is the
+    // larger of the two.
+    PathStats & operator+=(const PathStats &rhs);
+};
+
+struct NoStats
+{
+    void expand() {}
+    void generate() {}
+    void push(int) {}
+    void pop() {}
+    void decreaseKey() {}
+};
+
+// Add the wall time of a search to its stats when it goes out of scope.  A
+// search that runs in several pieces times each one, but only the first
+// counts as a new search.
+template <typename Stats>
+class SearchTimer
+{
+public:
+    explicit SearchTimer(Stats &, bool = true) {}
+};
+
+template <>
+class SearchTimer<PathStats>
+{
+public:
+    explicit SearchTimer(PathStats &stats, bool newSearch = true);
+    ~SearchTimer();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    PathStats &stats_;
+    Clock::time_point start_;
+};
+
+
+inline PathStats::PathStats()
+    : searches(0),
+    expanded(0),
+    generated(0),
+    pushes(0),
+    pops(0),
+    decreaseKeys(0),
+    peakOpen(0),
+    elapsed_ms(0.0)
+{
+}
+
+inline void PathStats::expand()
+{
+    ++expanded;
+}
+
+inline void PathStats::generate()
+{
+    ++generated;
+}
+
+inline void PathStats::push(int openSize)
+{
+    ++pushes;
+    peakOpen = std::max(peakOpen, openSize);
+}
+
+inline void PathStats::pop()
+{
+    ++pops;
+}
+
+inline void PathStats::decreaseKey()
+{
+    ++decreaseKeys;
+}
+
+inline PathStats & PathStats::operator+=(const PathStats &rhs)
+{
+    searches += rhs.searches;
+    expanded += rhs.expanded;
+    generated += rhs.generated;
+    pushes += rhs.pushes;
+    pops += rhs.pops;
+    decreaseKeys += rhs.decreaseKeys;
+    peakOpen = std::max(peakOpen, rhs.peakOpen);
+    elapsed_ms += rhs.elapsed_ms;
+    return *this;
+}
+
+
+inline SearchTimer<PathStats>::SearchTimer(PathStats &stats, bool newSearch)
+    : stats_(stats),
+    start_(Clock::now())
+{
+    if (newSearch) {
+        ++stats_.searches;
+    }
+}
+
+inline SearchTimer<PathStats>::~SearchTimer()
+{
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start_;
+    stats_.elapsed_ms += elapsed.count();
+}
+
+#endif
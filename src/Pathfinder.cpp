@@ -11,34 +11,17 @@
     See the COPYING.txt file for more details.
 */
 #include "Pathfinder.h"
-#include <algorithm>
-#include <memory>
-#include <unordered_map>
-
-struct PathNode
-{
-    int prev;
-    int costSoFar;
-    int estTotalCost;
-    bool visited;
-};
-
-typedef std::shared_ptr<PathNode> PathNodePtr;
-
-namespace {
-    PathNodePtr make_node(int prev, int costSoFar, int estTotalCost)
-    {
-        bool visited = false;
-        return std::make_shared<PathNode>(PathNode{prev, costSoFar,
-                                                   estTotalCost, visited});
-    }
-}
 
 Pathfinder::Pathfinder()
     : neighbors_{[] (int) { return std::vector<int>(); }},
+    revNeighbors_(),
     goal_{[] (int) { return false; }},
+    goalNode_(-1),
     stepCost_{[] (int, int) { return 1; }},
-    estimate_{[] (int) { return 0; }}
+    maxStepCost_(1),
+    estimate_{[] (int) { return 0; }},
+    revEstimate_{[] (int) { return 0; }},
+    weight_(1.0)
 {
 }
 
@@ -50,16 +33,27 @@ void Pathfinder::setNeighbors(std::function<std::vector<int> (int)> func)
 void Pathfinder::setGoal(int targetNode)
 {
     goal_ = [=] (int node) { return node == targetNode; };
+    goalNode_ = targetNode;
 }
 
 void Pathfinder::setGoal(std::function<bool (int)> func)
 {
     goal_ = func;
+    goalNode_ = -1;
 }
 
 void Pathfinder::setStepCost(std::function<int (int, int)> func)
 {
     stepCost_ = func;
+    maxStepCost_ = 0;
+}
+
+void Pathfinder::setStepCost(std::function<int (int, int)> func,
+                             int maxStepCost)
+{
+    assert(maxStepCost >= 0);
+    stepCost_ = func;
+    maxStepCost_ = maxStepCost;
 }
 
 void Pathfinder::setEstimate(std::function<int (int)> func)
@@ -67,81 +61,156 @@ void Pathfinder::setEstimate(std::function<int (int)> func)
     estimate_ = func;
 }
 
+void Pathfinder::setReverseNeighbors(
+    std::function<std::vector<int> (int)> func)
+{
+    revNeighbors_ = func;
+}
+
+void Pathfinder::setReverseEstimate(std::function<int (int)> func)
+{
+    revEstimate_ = func;
+}
+
+void Pathfinder::setWeight(double weight)
+{
+    assert(weight >= 1.0);
+    weight_ = weight;
+}
+
 std::vector<int> Pathfinder::getPathFrom(int start) const
 {
-    if (goal_(start)) return {start};
-
-    // Record shortest path costs for every node we examine.
-    std::unordered_map<int, PathNodePtr> nodes;
-    // Maintain a heap of nodes to consider.
-    std::vector<int> open;
-    int goalLoc = -1;
-    PathNodePtr goalNode;
-
-    // The heap functions confusingly use operator< to build a heap with the
-    // *largest* element on top.  We want to get the node with the *least* cost,
-    // so we have to order nodes in the opposite way.
-    auto orderByCost = [&] (int lhs, int rhs)
-    {
-        return nodes[lhs]->estTotalCost > nodes[rhs]->estTotalCost;
-    };
-
-    nodes.emplace(start, make_node(-1, 0, 0));
-    open.push_back(start);
-
-    // A* algorithm.  Decays to Dijkstra's if estimate function is always 0.
-    while (!open.empty()) {
-        auto loc = open.front();
-        pop_heap(std::begin(open), std::end(open), orderByCost);
-        open.pop_back();
-        if (goal_(loc)) {
-            goalLoc = loc;
-            goalNode = nodes[loc];
-            break;
-        }
+    return dispatch(start, nullptr, nullptr, nullptr);
+}
+
+std::vector<int> Pathfinder::getPathFrom(int start, PathScratch &scratch) const
+{
+    return dispatch(start, &scratch, nullptr, nullptr);
+}
 
-        auto &curNode = nodes[loc];
-        curNode->visited = true;
-        for (auto n : neighbors_(loc)) {
-            auto nIter = nodes.find(n);
-            auto step = stepCost_(loc, n);
-
-            if (nIter != nodes.end()) {
-                auto &nNode = nIter->second;
-                if (nNode->visited) {
-                    continue;
-                }
-
-                // Are we on a shorter path to the neighbor node than what
-                // we've already seen?  If so, update the neighbor's node data.
-                if (curNode->costSoFar + step < nNode->costSoFar) {
-                    nNode->prev = loc;
-                    nNode->costSoFar = curNode->costSoFar + step;
-                    nNode->estTotalCost = nNode->costSoFar + estimate_(n);
-                    make_heap(std::begin(open), std::end(open), orderByCost);
-                }
-            }
-            else {
-                // We haven't seen this node before.  Add it to the open list.
-                nodes.emplace(n, make_node(loc, curNode->costSoFar + step, 
-                    curNode->costSoFar + step + estimate_(n)));
-                open.push_back(n);
-                push_heap(std::begin(open), std::end(open), orderByCost);
-            }
+std::vector<int> Pathfinder::getPathFrom(int start, PathScratch &scratch,
+                                         PathScratch &revScratch) const
+{
+    return dispatch(start, &scratch, &revScratch, nullptr);
+}
+
+std::vector<int> Pathfinder::getPathFrom(int start, PathStats &stats) const
+{
+    return dispatch(start, nullptr, nullptr, &stats);
+}
+
+std::vector<int> Pathfinder::getPathFrom(int start, PathScratch &scratch,
+                                         PathStats &stats) const
+{
+    return dispatch(start, &scratch, nullptr, &stats);
+}
+
+std::vector<int> Pathfinder::getPathFrom(int start, PathScratch &scratch,
+                                         PathScratch &revScratch,
+                                         PathStats &stats) const
+{
+    return dispatch(start, &scratch, &revScratch, &stats);
+}
+
+BoundedPath Pathfinder::getBoundedPath(int start, double budget_ms) const
+{
+    return dispatchBounded(start, nullptr, budget_ms, nullptr);
+}
+
+BoundedPath Pathfinder::getBoundedPath(int start, PathScratch &scratch,
+                                       double budget_ms) const
+{
+    return dispatchBounded(start, &scratch, budget_ms, nullptr);
+}
+
+std::vector<int> Pathfinder::dispatch(int start, PathScratch *scratch,
+                                      PathScratch *revScratch,
+                                      PathStats *stats) const
+{
+    if (maxStepCost_ > 0) {
+        return search(boundedStepCost(std::cref(stepCost_), maxStepCost_),
+                      start, scratch, revScratch, stats);
+    }
+    return search(std::cref(stepCost_), start, scratch, revScratch, stats);
+}
+
+template <typename Cost>
+std::vector<int> Pathfinder::search(Cost stepCost, int start,
+                                    PathScratch *scratch,
+                                    PathScratch *revScratch,
+                                    PathStats *stats) const
+{
+    if (weight_ > 1.0) {
+        return boundedSearch(stepCost, start, scratch, 0.0, stats).path;
+    }
+
+    // A single scratch space means a one-sided search, even if we could
+    // search in both directions.
+    if (isBidirectional() && (!scratch || revScratch)) {
+        auto pf = makeBidirectionalPathfinder(CopyNeighbors(neighbors_),
+                                              CopyNeighbors(revNeighbors_),
+                                              stepCost, std::cref(estimate_),
+                                              std::cref(revEstimate_));
+        if (!scratch) {
+            return stats ? pf.getPath(start, goalNode_, *stats) :
+                pf.getPath(start, goalNode_);
         }
+        return stats ?
+            pf.getPath(start, goalNode_, *scratch, *revScratch, *stats) :
+            pf.getPath(start, goalNode_, *scratch, *revScratch);
+    }
+
+    auto pf = makePathfinder(CopyNeighbors(neighbors_), stepCost,
+                             std::cref(estimate_), std::cref(goal_));
+    if (!scratch) {
+        return stats ? pf.getPathFrom(start, *stats) : pf.getPathFrom(start);
+    }
+    return stats ? pf.getPathFrom(start, *scratch, *stats) :
+        pf.getPathFrom(start, *scratch);
+}
+
+BoundedPath Pathfinder::dispatchBounded(int start, PathScratch *scratch,
+                                        double budget_ms,
+                                        PathStats *stats) const
+{
+    if (maxStepCost_ > 0) {
+        return boundedSearch(boundedStepCost(std::cref(stepCost_),
+                                             maxStepCost_),
+                             start, scratch, budget_ms, stats);
     }
+    return boundedSearch(std::cref(stepCost_), start, scratch, budget_ms,
+                         stats);
+}
 
-    if (!goalNode) {
-        return {};
+template <typename Cost>
+BoundedPath Pathfinder::boundedSearch(Cost stepCost, int start,
+                                      PathScratch *scratch, double budget_ms,
+                                      PathStats *stats) const
+{
+    auto pf = makePathfinder(CopyNeighbors(neighbors_), stepCost,
+                             std::cref(estimate_), std::cref(goal_));
+    if (!scratch) {
+        return stats ? pf.getBoundedPath(start, weight_, budget_ms, *stats) :
+            pf.getBoundedPath(start, weight_, budget_ms);
     }
+    return stats ?
+        pf.getBoundedPath(start, *scratch, weight_, budget_ms, *stats) :
+        pf.getBoundedPath(start, *scratch, weight_, budget_ms);
+}
 
-    // Build the path from the chain of nodes leading to the goal.
-    std::vector<int> path = {goalLoc};
-    auto n = goalNode;
-    while (n->prev != -1) {
-        path.push_back(n->prev);
-        n = nodes[n->prev];
+bool Pathfinder::isBidirectional() const
+{
+    return revNeighbors_ && goalNode_ != -1;
+}
+
+Pathfinder::CopyNeighbors::CopyNeighbors(const NeighborFunc &func)
+    : func_(func)
+{
+}
+
+void Pathfinder::CopyNeighbors::operator()(int node, NeighborList &nbrs) const
+{
+    for (auto n : func_(node)) {
+        nbrs.push_back(n);
     }
-    reverse(std::begin(path), std::end(path));
-    return path;
 }
@@ -13,11 +13,15 @@
 #ifndef PATHFINDER_H
 #define PATHFINDER_H
 
+#include "BasicPathfinder.h"
+#include "BidirectionalPathfinder.h"
 #include <functional>
 #include <vector>
 
 // Generic implementation of the A* algorithm.  Suitable for any map or graph
-// whose nodes can be represented by integers.
+// whose nodes can be represented by integers.  This is a convenience wrapper
+// around BasicPathfinder that takes std::function objects.  Use BasicPathfinder
+// directly in performance-critical code.
 class Pathfinder
 {
 public:
@@ -39,6 +43,11 @@ public:
     // int (int a, int b) -> step cost from node a to node b.
     void setStepCost(std::function<int (int, int)> func);
 
+    // Same as above, with a promise that no step costs more than maxStepCost.
+    // Small integer costs let the search use buckets instead of a heap.  The
+    // default step cost is bounded by 1.
+    void setStepCost(std::function<int (int, int)> func, int maxStepCost);
+
     // (OPTIONAL) Define a lower-bound estimate for the cost needed to reach
     // the goal from a given node.  Bad paths can result if the estimate is too
     // high.  This is a performance optimization for when you know where the
@@ -46,15 +55,95 @@ public:
     // int (int a) -> estimate shortest path from node a to goal.
     void setEstimate(std::function<int (int)> func);
 
+    // (OPTIONAL) Search from both ends at once when the goal is a single node
+    // given to setGoal(int).  Provide the inverse of the neighbors function.
+    // For undirected graphs, it's the same function.  Any estimate function
+    // must be consistent: it can't drop by more than the step cost from one
+    // node to the next.
+    // std::vector<int> (int n) -> list of nodes that have n as a neighbor.
+    void setReverseNeighbors(std::function<std::vector<int> (int)> func);
+
+    // (OPTIONAL) Define a lower-bound estimate of the cost to reach a given
+    // node from the start, to guide the backward half of a bidirectional
+    // search.
+    // int (int a) -> estimate shortest path from start to node a.
+    void setReverseEstimate(std::function<int (int)> func);
+
+    // (OPTIONAL) Trade path length for speed by multiplying the estimate by
+    // this weight.  Paths cost at most weight times as much as the shortest
+    // path.  Default is 1, which finds the shortest path.  A weighted search
+    // is always one-sided.
+    void setWeight(double weight);
+
     // Return the shortest path to the goal from the starting node.  Return an
     // empty list if the goal cannot be found.
     std::vector<int> getPathFrom(int start) const;
 
+    // Same as above, but store node data in the given scratch space instead of
+    // a hash table.  Prefer this when node ids are dense and you run many
+    // searches over the same graph.  Bidirectional searches need a second
+    // scratch space for the backward half; without one, this searches forward
+    // only.
+    std::vector<int> getPathFrom(int start, PathScratch &scratch) const;
+    std::vector<int> getPathFrom(int start, PathScratch &scratch,
+                                 PathScratch &revScratch) const;
+
+    // Same as the above, but add counts of the work done to the given stats.
+    // Searches without stats don't pay for counting.
+    std::vector<int> getPathFrom(int start, PathStats &stats) const;
+    std::vector<int> getPathFrom(int start, PathScratch &scratch,
+                                 PathStats &stats) const;
+    std::vector<int> getPathFrom(int start, PathScratch &scratch,
+                                 PathScratch &revScratch,
+                                 PathStats &stats) const;
+
+    // Anytime search.  Find a path quickly using the weight above, then keep
+    // improving it until budget_ms runs out.  Returns the best path found and
+    // how far from the shortest path it could be.
+    BoundedPath getBoundedPath(int start, double budget_ms) const;
+    BoundedPath getBoundedPath(int start, PathScratch &scratch,
+                               double budget_ms) const;
+
 private:
-    std::function<std::vector<int> (int)> neighbors_;
+    using NeighborFunc = std::function<std::vector<int> (int)>;
+
+    // Copy a neighbor list into the form BasicPathfinder expects.
+    class CopyNeighbors
+    {
+    public:
+        explicit CopyNeighbors(const NeighborFunc &func);
+        void operator()(int node, NeighborList &nbrs) const;
+
+    private:
+        const NeighborFunc &func_;
+    };
+
+    template <typename Func>
+    using Ref = std::reference_wrapper<const std::function<Func>>;
+
+    // Run the search that fits the given arguments, any of which may be
+    // null.  Picks the open list based on whether the step cost is bounded.
+    std::vector<int> dispatch(int start, PathScratch *scratch,
+                              PathScratch *revScratch, PathStats *stats) const;
+    template <typename Cost>
+    std::vector<int> search(Cost stepCost, int start, PathScratch *scratch,
+                            PathScratch *revScratch, PathStats *stats) const;
+    BoundedPath dispatchBounded(int start, PathScratch *scratch,
+                                double budget_ms, PathStats *stats) const;
+    template <typename Cost>
+    BoundedPath boundedSearch(Cost stepCost, int start, PathScratch *scratch,
+                              double budget_ms, PathStats *stats) const;
+    bool isBidirectional() const;
+
+    NeighborFunc neighbors_;
+    NeighborFunc revNeighbors_;
     std::function<bool (int)> goal_;
+    int goalNode_;  // -1 if the goal is described by a function
     std::function<int (int, int)> stepCost_;
+    int maxStepCost_;  // 0 if unknown
     std::function<int (int)> estimate_;
+    std::function<int (int)> revEstimate_;
+    double weight_;
 };
 
 #endif
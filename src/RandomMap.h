@@ -14,9 +14,13 @@
 #define RANDOM_MAP_H
 
 #include "HexGrid.h"
+#include "HexLayer.h"
+#include "PathCache.h"
+#include "PathStats.h"
+#include "RegionMap.h"
+#include "SlicedPathfinder.h"
 #include "hex_utils.h"
 #include "sdl_helper.h"
-#include "terrain.h"
 #include <vector>
 
 class RandomMap
@@ -24,11 +28,11 @@ class RandomMap
 public:
     // Create a map and define the visible portion on the screen.  Minimum size
     // is 2x1.
-    RandomMap(Sint16 hWidth, Sint16 hHeight, const SDL_Rect &pDisplayArea);
+    RandomMap(int hWidth, int hHeight, const SDL_Rect &pDisplayArea);
 
     // Size of the entire map in pixels.
-    Sint16 pWidth() const;
-    Sint16 pHeight() const;
+    int pWidth() const;
+    int pHeight() const;
 
     // Size of the visible map area only in pixels.
     const SDL_Rect & getDisplayArea() const;
@@ -37,114 +41,109 @@ public:
     // We can draw anywhere between (0,0) and maxPixel() and still keep the
     // display area filled.
     Point maxPixel() const;
-    void draw(Sint16 mpx, Sint16 mpy);
+    void draw(int mpx, int mpy);
     void redraw();  // use last draw position
 
     // Return the last draw() target.
     Point mDrawnAt() const;
 
     // Return the hex currently drawn at the given pixel.
-    Point getHexAtS(Sint16 spx, Sint16 spy) const;
+    Point getHexAtS(int spx, int spy) const;
     Point getHexAtS(const Point &sp) const;
-    Point getHexAtM(Sint16 mpx, Sint16 mpy) const;
+    Point getHexAtM(int mpx, int mpy) const;
     Point getHexAtM(const Point &mp) const;
 
     // Return the screen coordinates of the given hex.
-    Point sPixelFromHex(Sint16 hx, Sint16 hy) const;
+    Point sPixelFromHex(int hx, int hy) const;
     Point sPixelFromHex(const Point &hex) const;
 
     // Get the terrain type at the given map coordinates.
-    int getTerrainAt(Sint16 mpx, Sint16 mpy) const;
+    int getTerrainAt(int mpx, int mpy) const;
 
     // Highlight the given hex.
     void selectHex(const Point &hex);
     Point getSelectedHex() const;
 
+    // Paths are cached, so hovering back and forth over the same hexes is
+    // cheap.
     void highlightPath(const Point &hSrc, const Point &hDest);
+    const PathCache & getPathCache() const;
+
+    // Optionally record how much work each search did while finding the last
+    // highlighted path, one entry per leg.  The search through the portals
+    // comes first.  Empty if stats are off or the path came from the cache.
+    void setCollectStats(bool enabled);
+    const std::vector<PathStats> & getPathStats() const;
+
+    // Time-sliced version of highlightPath(), to keep hard paths from
+    // stalling a frame.  Queue up a path to find, and updatePath() does the
+    // work a slice at a time.  The previous path stays highlighted until the
+    // new one is done.  Only the latest request matters, so it replaces any
+    // still pending.  Stats cover the last request to finish.
+    void requestPath(const Point &hSrc, const Point &hDest);
+
+    // Work on the pending request until it's done or the budget runs out.
+    // Return true if the highlighted path changed.
+    bool updatePath(SliceBudget &budget);
+    bool pathPending() const;
+
+    // Index the map for exact paths that are found right away.  Worth it if
+    // the map stays up for a while.  See RegionMap::buildPathIndex().
+    void buildPathIndex();
 
     // Return true if the given hex doesn't have an obstacle.
     bool walkable(const Point &hex) const;
 
 private:
-    // Use a Voronoi diagram to generate a random set of regions.
-    void generateRegions();
-    void recalcHexCenters();
-
-    // Construct an adjacency list for each region.
-    void buildRegionGraph();
-
-    void generateObstacles();
     void assignTerrain();
     void setObstacleImages();
-    void drawTile(Sint16 hx, Sint16 hy);
-    void drawObstacle(Sint16 hx, Sint16 hy);
-
-    // Ensure all walkable hexes in each region are reachable from every other
-    // walkable hex.
-    void makeWalkable();
-    void makeRegionWalkable(std::vector<int> &hexes, std::vector<char> &visited);
+    void drawTile(int hx, int hy);
+    void drawObstacle(int hx, int hy);
 
     // The terrain grid extends from (-1,-1) to (hWidth,hHeight) inclusive on
     // the main grid.  These conversions let us always refer to the map in main
     // grid coordinates.  Return -1 if the result is outside the terrain grid.
     int tIndex(int mIndex) const;
     int tIndex(const Point &mHex) const;
-    int tIndex(Sint16 hx, Sint16 hy) const;
+    int tIndex(int hx, int hy) const;
 
     // Convert between screen coordinates and map coordinates.
     Point mPixel(const Point &sp) const;
-    Point mPixel(Sint16 spx, Sint16 spy) const;
+    Point mPixel(int spx, int spy) const;
     Point sPixel(const Point &mp) const;
-    Point sPixel(Sint16 mpx, Sint16 mpy) const;
+    Point sPixel(int mpx, int mpy) const;
     Point sPixel(int mIndex) const;
 
-    bool walkable(int mIndex) const;
-
-    // Find shortest number of hops between regions.  Intended as a high-level
-    // first pass at generating paths between distant hexes.
-    std::vector<int> getRegionPath(int rBegin, int rEnd) const;
-
-    // Return the shortest path between two hexes in the same region or an
-    // adjacent region.
-    std::vector<int> getPath(int aSrc, int aDest) const;
-
-    // Return a path to the nearest hex in an adjacent region.
-    std::vector<int> getPathToReg(int aSrc, int rDest) const;
-
     HexGrid mgrid_;
-    Sint16 pWidth_;
-    Sint16 pHeight_;
-    int numRegions_;
-    std::vector<int> regions_;  // assign each tile to a region [0,numRegions)
-    std::vector<Point> centers_;  // center hex of each region
-    AdjacencyList regionGraph_;
-    AdjacencyList regionGraphWalk_;  // walkable paths to adjacent regions
+    RegionMap map_;  // everything but the graphics
+    int pWidth_;
+    int pHeight_;
 
     // To help make the edges of the map look nice, we extend the grid by one
     // hex in every direction.
     HexGrid tgrid_;
-    std::vector<int> terrain_;
-    std::vector<char> tObst_;  // 1=obstacle present, 0=none
+    LinearLayer<int> terrain_;
+    LinearLayer<char> tObst_;  // 1=obstacle present, 0=none
 
     struct Obstacle
     {
-        Sint16 pxOffset;  // handle images not sized exactly to one hex
-        Sint16 pyOffset;
+        int pxOffset;  // handle images not sized exactly to one hex
+        int pyOffset;
         SdlSurface img;
         
         Obstacle() : pxOffset(0), pyOffset(0), img() {}
     };
-    std::vector<Obstacle> tObstImg_;  // which obstacle graphics to use
+    LinearLayer<Obstacle> tObstImg_;  // which obstacle graphics to use
 
     // Visible portion of the map.  Max pixel is defined so that the display
     // area is always filled.
     SDL_Rect pDisplayArea_;
-    Sint16 mMaxX_;
-    Sint16 mMaxY_;
+    int mMaxX_;
+    int mMaxY_;
 
     // Current upper-left pixel in map coordinates.
-    Sint16 px_;
-    Sint16 py_;
+    int px_;
+    int py_;
 
     Point selectedHex_;
     std::vector<int> selectedPath_;
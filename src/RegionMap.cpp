@@ -0,0 +1,1306 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#include "RegionMap.h"
+
+#include "algo.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <queue>
+#include <random>
+#include <utility>
+
+namespace {
+    // Region routing table entry when there's no next hop.
+    const unsigned char noRoute = 255;
+
+    bool areNeighbors(const HexGrid &grid, int a, int b)
+    {
+        return hexDist(grid.hexFromAry(a), grid.hexFromAry(b)) == 1;
+    }
+
+    // Wrap up a sliced search so a path request can hold any kind.
+    template <typename Search>
+    std::function<bool (SliceBudget &, std::vector<int> &, PathStats *)>
+    legSearch(Search search)
+    {
+        return [search] (SliceBudget &budget, std::vector<int> &path,
+                         PathStats *stats) mutable {
+            auto done = stats ? search.resume(budget, *stats) :
+                search.resume(budget);
+            if (!done) return false;
+            path = search.getPath();
+            return true;
+        };
+    }
+}
+
+RegionMap::RegionMap(int hWidth, int hHeight, int numRegions, int numLandmarks)
+    : mgrid_(hWidth, hHeight),
+    numRegions_(numRegions),
+    regions_(mgrid_, -1),
+    centers_(),
+    regionGraph_(numRegions_),
+    obst_(mgrid_.size(), 0),
+    areas_(),
+    borders_(),
+    portalIndex_(mgrid_.size(), -1),
+    portalEdges_(),
+    freePortals_(),
+    regionPortals_(),
+    onBorder_(),
+    stepDist_(),
+    regionLinks_(),
+    regionNextHop_(),
+    hexScratch_(mgrid_.size()),
+    jumpPf_(),
+    numLandmarks_(numLandmarks),
+    landmarks_(),
+    pathIndex_(),
+    revScratch_(),
+    pathMode_(PathMode::Portals),
+    mapVersion_(0),
+    pathCache_(256),
+    collectStats_(false),
+    pathStats_(),
+    request_(),
+    requestedPath_(),
+    sliceScratch_(mgrid_.size())
+{
+    assert(hWidth > 1);
+
+    generateRegions();
+    generateObstacles();
+    makeWalkable();
+    auto isWalkable = [this] (int aIndex) { return walkable(aIndex); };
+    areas_ = make_unique<ComponentLabels>(mgrid_, isWalkable);
+    jumpPf_ = make_unique<JumpPathfinder>(mgrid_, isWalkable,
+        [this] (int aIndex) { return regions_[aIndex]; });
+    if (numLandmarks_ > 0) {
+        landmarks_ = make_unique<Landmarks>(mgrid_, isWalkable,
+                                            numLandmarks_);
+    }
+    buildRegionGraph();
+    buildPortalGraph();
+}
+
+const HexGrid & RegionMap::grid() const
+{
+    return mgrid_;
+}
+
+int RegionMap::numRegions() const
+{
+    return numRegions_;
+}
+
+int RegionMap::region(int aIndex) const
+{
+    assert(aIndex >= 0 && aIndex < mgrid_.size());
+    return regions_[aIndex];
+}
+
+const AdjacencyList & RegionMap::regionGraph() const
+{
+    return regionGraph_;
+}
+
+int RegionMap::numPortals() const
+{
+    return portalEdges_.size() - freePortals_.size();
+}
+
+std::vector<int> RegionMap::getRegionRoute(int rSrc, int rDest) const
+{
+    assert(rSrc >= 0 && rSrc < numRegions_);
+    assert(rDest >= 0 && rDest < numRegions_);
+
+    std::vector<int> route = {rSrc};
+    while (route.back() != rDest) {
+        auto reg = route.back();
+        auto hop = regionNextHop_[reg * numRegions_ + rDest];
+        if (hop == noRoute) return {};
+        route.push_back(regionLinks_[reg][hop]);
+    }
+    return route;
+}
+
+bool RegionMap::walkable(int aIndex) const
+{
+    if (aIndex < 0 || aIndex >= mgrid_.size()) {
+        return false;
+    }
+
+    return obst_[aIndex] == 0;
+}
+
+bool RegionMap::walkable(const Point &hex) const
+{
+    return walkable(mgrid_.aryFromHex(hex));
+}
+
+void RegionMap::setObstacle(int aIndex, bool present)
+{
+    assert(aIndex >= 0 && aIndex < mgrid_.size());
+    if (walkable(aIndex) != present) return;
+
+    obst_[aIndex] = present ? 1 : 0;
+    if (present) {
+        areas_->remove(aIndex);
+        jumpPf_->remove(aIndex);
+        if (landmarks_) {
+            landmarks_->remove(aIndex);
+        }
+    }
+    else {
+        areas_->add(aIndex);
+        jumpPf_->add(aIndex);
+        if (landmarks_) {
+            landmarks_->add(aIndex);
+        }
+    }
+
+    updatePortals(aIndex);
+    pathIndex_.reset();
+    mapChanged();
+}
+
+void RegionMap::buildPathIndex()
+{
+    pathIndex_ = make_unique<ContractionHierarchy>(mgrid_,
+        [this] (int aIndex) { return walkable(aIndex); });
+    revScratch_.resize(mgrid_.size());
+
+    // Cached paths might not be the shortest.
+    mapChanged();
+}
+
+const ContractionHierarchy * RegionMap::getPathIndex() const
+{
+    return pathIndex_.get();
+}
+
+std::vector<int> RegionMap::findPath(int aSrc, int aDest)
+{
+    pathStats_.clear();
+    if (!walkable(aSrc) || !walkable(aDest) ||
+        !areas_->connected(aSrc, aDest))
+    {
+        return {};
+    }
+
+    auto cached = pathCache_.find(aSrc, aDest, mapVersion_);
+    if (cached) {
+        return *cached;
+    }
+    auto path = buildPath(aSrc, aDest, collectStats_ ? &pathStats_ : nullptr);
+    pathCache_.insert(aSrc, aDest, mapVersion_, path);
+    return path;
+}
+
+const PathCache & RegionMap::getPathCache() const
+{
+    return pathCache_;
+}
+
+void RegionMap::setPathMode(PathMode mode)
+{
+    if (mode == pathMode_) return;
+
+    // The cached paths came from the other mode.
+    pathMode_ = mode;
+    mapChanged();
+}
+
+void RegionMap::setCollectStats(bool enabled)
+{
+    collectStats_ = enabled;
+}
+
+const std::vector<PathStats> & RegionMap::getPathStats() const
+{
+    return pathStats_;
+}
+
+bool RegionMap::requestPath(int aSrc, int aDest)
+{
+    request_ = PathRequest();
+    pathStats_.clear();
+    if (!walkable(aSrc) || !walkable(aDest)) {
+        requestedPath_.clear();
+        return true;
+    }
+
+    // No need to wait if we already know the answer.
+    auto cached = pathCache_.find(aSrc, aDest, mapVersion_);
+    if (cached || aSrc == aDest) {
+        requestedPath_ = cached ? *cached : std::vector<int>{aSrc};
+        return true;
+    }
+
+    if (!areas_->connected(aSrc, aDest)) {
+        requestedPath_.clear();
+        return true;
+    }
+
+    // Indexed paths are too quick to bother spreading over several frames.
+    if (pathIndex_) {
+        requestedPath_ = buildPath(aSrc, aDest, nullptr);
+        pathCache_.insert(aSrc, aDest, mapVersion_, requestedPath_);
+        return true;
+    }
+
+    if (!canReach(regions_[aSrc], regions_[aDest])) {
+        requestedPath_.clear();
+        return true;
+    }
+
+    request_.aSrc = aSrc;
+    request_.aDest = aDest;
+    request_.mapVersion = mapVersion_;
+    request_.path = {aSrc};
+    if (regions_[aSrc] == regions_[aDest]) {
+        request_.portalPath = {aSrc, aDest};
+        request_.nextStep = 2;
+        request_.leg = slicedPath(aSrc, aDest);
+        request_.restricted = true;
+    }
+    else if (pathMode_ == PathMode::Corridor) {
+        request_.portalPath = {aSrc, aDest};
+        request_.nextStep = 2;
+        request_.leg = slicedCorridorPath(aSrc, aDest);
+        request_.restricted = true;
+    }
+    else {
+        request_.leg = slicedPortalPath(aSrc, aDest);
+    }
+    return false;
+}
+
+bool RegionMap::updatePath(SliceBudget &budget)
+{
+    if (!request_.leg) return false;
+
+    // Anything found so far is no good if the map has changed.
+    if (request_.mapVersion != mapVersion_) {
+        if (requestPath(request_.aSrc, request_.aDest)) return true;
+    }
+
+    std::vector<int> leg;
+    while (request_.leg) {
+        auto stats = collectStats_ ? &request_.legStats : nullptr;
+        if (!request_.leg(budget, leg, stats)) return false;
+        finishLeg(leg);
+    }
+
+    requestedPath_ = request_.path;
+    pathStats_ = request_.pathStats;
+    pathCache_.insert(request_.aSrc, request_.aDest, mapVersion_,
+                      requestedPath_);
+    return true;
+}
+
+bool RegionMap::pathPending() const
+{
+    return static_cast<bool>(request_.leg);
+}
+
+const std::vector<int> & RegionMap::getRequestedPath() const
+{
+    return requestedPath_;
+}
+
+void RegionMap::generateRegions()
+{
+    // Start with a set of random hexes.  Don't worry if there are duplicates.
+    generate_n(std::back_inserter(centers_),
+               numRegions_,
+               [this] { return mgrid_.hexRandom(); });
+
+    // Find the closest center to each hex on the map.  The set of hexes
+    // closest to center #0 will be region 0, etc.  Repeat this several times
+    // for more regular-looking regions.
+    for (int i = 0; i < 4; ++i) {
+        for (int aIndex = 0; aIndex < mgrid_.size(); ++aIndex) {
+            regions_[aIndex] = findClosest(mgrid_.hexFromAry(aIndex), centers_);
+        }
+        recalcHexCenters();
+    }
+
+    // Assign each hex to its final region.
+    for (int aIndex = 0; aIndex < mgrid_.size(); ++aIndex) {
+        regions_[aIndex] = findClosest(mgrid_.hexFromAry(aIndex), centers_);
+    }
+
+    mapChanged();
+}
+
+void RegionMap::recalcHexCenters()
+{
+    // Sum in ints, big maps overflow a Point.
+    std::vector<std::pair<int, int>> hexSums(numRegions_);
+    std::vector<int> numHexes(numRegions_);
+
+    for (int hx = 0; hx < mgrid_.width(); ++hx) {
+        for (int hy = 0; hy < mgrid_.height(); ++hy) {
+            int region = regions_[mgrid_.aryFromHex(hx, hy)];
+            assert(region >= 0 && region < numRegions_);
+
+            auto &hs = hexSums[region];
+            hs.first += hx;
+            hs.second += hy;
+            ++numHexes[region];
+        }
+    }
+
+    for (int r = 0; r < numRegions_; ++r) {
+        // The Voronoi algorithm sometimes leads to regions being "absorbed" by
+        // their neighbors.  Leave the default (invalid) center hex in place
+        // for an empty region.
+        if (numHexes[r] > 0) {
+            auto &hc = centers_[r];
+            auto &hs = hexSums[r];
+            hc.first = hs.first / numHexes[r];
+            hc.second = hs.second / numHexes[r];
+        }
+    }
+}
+
+void RegionMap::buildRegionGraph()
+{
+    for (int i = 0; i < mgrid_.size(); ++i) {
+        auto reg = regions_[i];
+        assert(reg >= 0 && reg < numRegions_);
+
+        for (const auto &an : mgrid_.aryNeighbors(i)) {
+            auto rNeighbor = regions_[an];
+            if (rNeighbor == reg) continue;
+
+            // If an adjacent hex is in a different region and we haven't
+            // already recorded that region as a neighbor, save it.
+            if (!contains(regionGraph_[reg], rNeighbor)) {
+                regionGraph_[reg].push_back(rNeighbor);
+            }
+        }
+    }
+
+    // Find the hexes along each border, on the side of the lower numbered
+    // region.
+    for (int i = 0; i < mgrid_.size(); ++i) {
+        for (auto d : Dir()) {
+            auto n = mgrid_.aryGetNeighbor(i, d);
+            if (n == -1 || regions_[n] <= regions_[i]) continue;
+            auto &hexes = borders_[std::make_pair(regions_[i], regions_[n])];
+            if (hexes.empty() || hexes.back() != i) {
+                hexes.push_back(i);
+            }
+        }
+    }
+
+    mapChanged();
+}
+
+void RegionMap::buildPortalGraph()
+{
+    portalIndex_.assign(mgrid_.size(), -1);
+    portalEdges_.clear();
+    freePortals_.clear();
+    regionPortals_.assign(numRegions_, std::vector<int>());
+    onBorder_.assign(mgrid_.size(), 0);
+    stepDist_.assign(mgrid_.size(), -1);
+
+    for (const auto &b : borders_) {
+        placePortals(b.first.first, b.first.second);
+    }
+    for (int r = 0; r < numRegions_; ++r) {
+        linkPortals(r);
+    }
+
+    buildRegionRoutes();
+}
+
+void RegionMap::updatePortals(int aIndex)
+{
+    // Regions across the borders this hex is on.
+    auto reg = regions_[aIndex];
+    std::vector<int> others;
+    for (auto n : mgrid_.aryNeighbors(aIndex)) {
+        if (regions_[n] != reg && !contains(others, regions_[n])) {
+            others.push_back(regions_[n]);
+        }
+    }
+
+    auto touched = others;
+    touched.push_back(reg);
+    std::vector<std::vector<int>> oldPortals;
+    for (auto r : touched) {
+        oldPortals.push_back(regionPortals_[r]);
+        sort(std::begin(oldPortals.back()), std::end(oldPortals.back()));
+    }
+
+    // Take down the links across each of those borders and put them back
+    // wherever the walkable crossings are now.
+    auto unlink = [this] (int r, int rAcross) {
+        for (auto hex : regionPortals_[r]) {
+            auto &edges = portalEdges_[portalIndex_[hex]];
+            edges.erase(remove_if(std::begin(edges), std::end(edges),
+                [this, rAcross] (const PortalEdge &e) {
+                    return regions_[e.aIndex] == rAcross;
+                }), std::end(edges));
+        }
+    };
+    for (auto rOther : others) {
+        unlink(reg, rOther);
+        unlink(rOther, reg);
+        placePortals(std::min(reg, rOther), std::max(reg, rOther));
+    }
+
+    // Portals with no way across any border are gone.  The distances between
+    // portals need redoing in regions whose portals moved.  If they didn't
+    // move in this hex's region, only paths through the hex can change.
+    std::vector<int> portals;
+    for (auto i = 0u; i < touched.size(); ++i) {
+        auto r = touched[i];
+        portals = regionPortals_[r];
+        for (auto hex : portals) {
+            const auto &edges = portalEdges_[portalIndex_[hex]];
+            auto crosses = any_of(std::begin(edges), std::end(edges),
+                [this, r] (const PortalEdge &e) {
+                    return regions_[e.aIndex] != r;
+                });
+            if (!crosses) {
+                removePortal(hex);
+            }
+        }
+
+        portals = regionPortals_[r];
+        sort(std::begin(portals), std::end(portals));
+        if (portals != oldPortals[i]) {
+            linkPortals(r);
+        }
+        else if (r == reg) {
+            relinkPortals(aIndex);
+        }
+    }
+
+    // The routes only change if a pair of regions gains its first way across
+    // their border or loses its last.
+    for (auto rOther : others) {
+        auto linked = any_of(std::begin(regionPortals_[reg]),
+                             std::end(regionPortals_[reg]),
+            [this, rOther] (int hex) {
+                const auto &edges = portalEdges_[portalIndex_[hex]];
+                return any_of(std::begin(edges), std::end(edges),
+                    [this, rOther] (const PortalEdge &e) {
+                        return regions_[e.aIndex] == rOther;
+                    });
+            });
+        if (linked != contains(regionLinks_[reg], rOther)) {
+            setRegionLink(reg, rOther, linked);
+        }
+    }
+}
+
+void RegionMap::placePortals(int rFirst, int rSecond)
+{
+    auto b = borders_.find(std::make_pair(rFirst, rSecond));
+    assert(b != std::end(borders_));
+    const auto &hexes = b->second;
+
+    // Can a path cross the border from this hex?
+    auto crossing = [this, rSecond] (int aIndex) {
+        if (!walkable(aIndex)) return -1;
+        for (auto d : Dir()) {
+            auto n = mgrid_.aryGetNeighbor(aIndex, d);
+            if (n != -1 && regions_[n] == rSecond && walkable(n)) return n;
+        }
+        return -1;
+    };
+
+    // Split the border into sections and put a portal at the walkable
+    // crossing nearest the middle of each one.  Regions start out with no
+    // islands, so one portal is enough for any path to get through.  More of
+    // them keep paths from detouring to reach one.
+    const int portalSpacing = 32;
+    auto &dist = stepDist_;
+    std::vector<int> line;
+    auto walkBorder = [&] (int start) {
+        // Breadth-first search along the border, return the farthest hex.
+        for (auto hex : line) {
+            dist[hex] = -1;
+        }
+        line.assign(1, start);
+        dist[start] = 0;
+        for (auto i = 0u; i < line.size(); ++i) {
+            auto hex = line[i];
+            for (auto d : Dir()) {
+                auto n = mgrid_.aryGetNeighbor(hex, d);
+                if (n != -1 && onBorder_[n] && dist[n] == -1) {
+                    dist[n] = dist[hex] + 1;
+                    line.push_back(n);
+                }
+            }
+        }
+        return line.back();
+    };
+
+    for (auto hex : hexes) {
+        onBorder_[hex] = 1;
+    }
+
+    for (auto hex : hexes) {
+        if (onBorder_[hex] != 1) continue;
+
+        // Measure from one end of the border to the other.  Regions can
+        // touch in more than one place.
+        walkBorder(walkBorder(hex));
+        auto length = dist[line.back()] + 1;
+        auto numSections = 1 + length / portalSpacing;
+
+        for (auto i = 0; i < numSections; ++i) {
+            auto first = i * length / numSections;
+            auto last = (i + 1) * length / numSections;
+            auto middle = (first + last) / 2;
+            auto best = -1;
+            auto bestPartner = -1;
+            for (auto h : line) {
+                if (dist[h] < first || dist[h] >= last) continue;
+                if (best != -1 &&
+                    abs(dist[h] - middle) >= abs(dist[best] - middle)) {
+                    continue;
+                }
+                auto partner = crossing(h);
+                if (partner != -1) {
+                    best = h;
+                    bestPartner = partner;
+                }
+            }
+            if (best == -1) continue;
+
+            portalEdges_[addPortal(best)].push_back({bestPartner, 1});
+            portalEdges_[addPortal(bestPartner)].push_back({best, 1});
+        }
+        for (auto h : line) {
+            onBorder_[h] = 2;
+        }
+    }
+
+    for (auto hex : hexes) {
+        onBorder_[hex] = 0;
+    }
+    for (auto hex : line) {
+        dist[hex] = -1;
+    }
+}
+
+void RegionMap::linkPortals(int reg)
+{
+    for (auto src : regionPortals_[reg]) {
+        linkPortal(src);
+    }
+}
+
+void RegionMap::linkPortal(int aIndex)
+{
+    auto reg = regions_[aIndex];
+    const auto &portals = regionPortals_[reg];
+    auto &edges = portalEdges_[portalIndex_[aIndex]];
+    edges.erase(remove_if(std::begin(edges), std::end(edges),
+        [this, reg] (const PortalEdge &e) {
+            return regions_[e.aIndex] == reg;
+        }), std::end(edges));
+
+    // Link to the other portals by the length of the shortest path to each.
+    // Stop once we've found all the ones we can reach.
+    auto &dist = stepDist_;
+    auto numFound = 1u;
+    std::vector<int> visited = {aIndex};
+    dist[aIndex] = 0;
+    for (auto i = 0u; i < visited.size() && numFound < portals.size(); ++i) {
+        auto hex = visited[i];
+        for (auto d : Dir()) {
+            auto n = mgrid_.aryGetNeighbor(hex, d);
+            if (n == -1 || dist[n] != -1 || regions_[n] != reg ||
+                !walkable(n))
+            {
+                continue;
+            }
+            dist[n] = dist[hex] + 1;
+            visited.push_back(n);
+            if (portalIndex_[n] != -1) {
+                edges.push_back({n, dist[n]});
+                ++numFound;
+            }
+        }
+    }
+
+    for (auto hex : visited) {
+        dist[hex] = -1;
+    }
+}
+
+void RegionMap::relinkPortals(int aIndex)
+{
+    // Only paths through the hex can change.  Measure from it to each portal
+    // in its region, the same whether it's open or not.
+    auto reg = regions_[aIndex];
+    const auto &portals = regionPortals_[reg];
+    auto &dist = stepDist_;
+    auto numFound = 0u;
+    std::vector<int> visited = {aIndex};
+    dist[aIndex] = 0;
+    for (auto i = 0u; i < visited.size() && numFound < portals.size(); ++i) {
+        auto hex = visited[i];
+        for (auto d : Dir()) {
+            auto n = mgrid_.aryGetNeighbor(hex, d);
+            if (n == -1 || dist[n] != -1 || regions_[n] != reg ||
+                !walkable(n))
+            {
+                continue;
+            }
+            dist[n] = dist[hex] + 1;
+            visited.push_back(n);
+            if (portalIndex_[n] != -1) {
+                ++numFound;
+            }
+        }
+    }
+
+    std::vector<int> stale;
+    for (auto src : portals) {
+        if (dist[src] == -1) continue;
+        auto &edges = portalEdges_[portalIndex_[src]];
+
+        if (walkable(aIndex)) {
+            // The hex just opened, so going through it might be shorter.
+            for (auto dest : portals) {
+                if (dest == src || dist[dest] == -1) continue;
+                auto viaHex = dist[src] + dist[dest];
+                auto e = find_if(std::begin(edges), std::end(edges),
+                    [dest] (const PortalEdge &pe) {
+                        return pe.aIndex == dest;
+                    });
+                if (e == std::end(edges)) {
+                    edges.push_back({dest, viaHex});
+                }
+                else if (viaHex < e->cost) {
+                    e->cost = viaHex;
+                }
+            }
+        }
+        else {
+            // The hex just got blocked.  Any portal with a shortest path
+            // through it has to measure again.
+            auto throughHex = any_of(std::begin(edges), std::end(edges),
+                [&] (const PortalEdge &e) {
+                    return regions_[e.aIndex] == reg && dist[e.aIndex] != -1 &&
+                        dist[src] + dist[e.aIndex] == e.cost;
+                });
+            if (throughHex) {
+                stale.push_back(src);
+            }
+        }
+    }
+
+    for (auto hex : visited) {
+        dist[hex] = -1;
+    }
+    for (auto src : stale) {
+        linkPortal(src);
+    }
+}
+
+int RegionMap::addPortal(int aIndex)
+{
+    if (portalIndex_[aIndex] != -1) {
+        return portalIndex_[aIndex];
+    }
+
+    if (freePortals_.empty()) {
+        portalIndex_[aIndex] = portalEdges_.size();
+        portalEdges_.emplace_back();
+    }
+    else {
+        portalIndex_[aIndex] = freePortals_.back();
+        freePortals_.pop_back();
+    }
+    regionPortals_[regions_[aIndex]].push_back(aIndex);
+    return portalIndex_[aIndex];
+}
+
+void RegionMap::removePortal(int aIndex)
+{
+    auto p = portalIndex_[aIndex];
+    assert(p != -1);
+    portalEdges_[p].clear();
+    freePortals_.push_back(p);
+    portalIndex_[aIndex] = -1;
+
+    auto &portals = regionPortals_[regions_[aIndex]];
+    portals.erase(find(std::begin(portals), std::end(portals), aIndex));
+}
+
+void RegionMap::buildRegionRoutes()
+{
+    regionLinks_.assign(numRegions_, std::vector<int>());
+    for (int i = 0; i < mgrid_.size(); ++i) {
+        if (portalIndex_[i] == -1) continue;
+        auto reg = regions_[i];
+        for (const auto &e : portalEdges_[portalIndex_[i]]) {
+            auto rNeighbor = regions_[e.aIndex];
+            if (rNeighbor != reg && !contains(regionLinks_[reg], rNeighbor)) {
+                regionLinks_[reg].push_back(rNeighbor);
+            }
+        }
+    }
+
+    regionNextHop_.assign(numRegions_ * numRegions_, noRoute);
+    for (int rDest = 0; rDest < numRegions_; ++rDest) {
+        routeTo(rDest);
+    }
+}
+
+void RegionMap::setRegionLink(int rFirst, int rSecond, bool linked)
+{
+    // Number of borders crossed from one region to another, -1 if there's no
+    // route.
+    auto numHops = [this] (int rSrc, int rDest) {
+        if (!canReach(rSrc, rDest)) return -1;
+        return static_cast<int>(getRegionRoute(rSrc, rDest).size()) - 1;
+    };
+
+    std::vector<int> dests;
+    if (linked) {
+        // The new link only makes a route shorter if one side was at least
+        // two hops farther than the other, or had no route at all.
+        for (int rDest = 0; rDest < numRegions_; ++rDest) {
+            auto first = numHops(rFirst, rDest);
+            auto second = numHops(rSecond, rDest);
+            if (first != second &&
+                (first == -1 || second == -1 || abs(first - second) > 1))
+            {
+                dests.push_back(rDest);
+            }
+        }
+        regionLinks_[rFirst].push_back(rSecond);
+        regionLinks_[rSecond].push_back(rFirst);
+    }
+    else {
+        // Only routes that crossed the old link need another look.  Hops are
+        // indexes into the list of links, so renumber the ones after it.
+        auto unlink = [&] (int reg, int rOld) {
+            auto &links = regionLinks_[reg];
+            auto hop = find(std::begin(links), std::end(links), rOld) -
+                std::begin(links);
+            links.erase(std::begin(links) + hop);
+            for (int rDest = 0; rDest < numRegions_; ++rDest) {
+                auto &next = regionNextHop_[reg * numRegions_ + rDest];
+                if (next == noRoute || next < hop) continue;
+                if (next == hop && !contains(dests, rDest)) {
+                    dests.push_back(rDest);
+                }
+                --next;
+            }
+        };
+        unlink(rFirst, rSecond);
+        unlink(rSecond, rFirst);
+    }
+
+    for (auto rDest : dests) {
+        routeTo(rDest);
+    }
+}
+
+void RegionMap::routeTo(int rDest)
+{
+    for (int reg = 0; reg < numRegions_; ++reg) {
+        regionNextHop_[reg * numRegions_ + rDest] = noRoute;
+    }
+
+    // Breadth-first search out from the destination.  Portals link both
+    // ways, so the first time we reach a region, the region we came from is
+    // its next hop.
+    std::vector<char> reached(numRegions_, 0);
+    reached[rDest] = 1;
+    std::vector<int> queue = {rDest};
+    for (auto i = 0u; i < queue.size(); ++i) {
+        auto reg = queue[i];
+        for (auto n : regionLinks_[reg]) {
+            if (reached[n]) continue;
+            reached[n] = 1;
+            queue.push_back(n);
+
+            const auto &links = regionLinks_[n];
+            auto hop = find(std::begin(links), std::end(links), reg) -
+                std::begin(links);
+            assert(hop < noRoute);
+            regionNextHop_[n * numRegions_ + rDest] = hop;
+        }
+    }
+}
+
+bool RegionMap::canReach(int rSrc, int rDest) const
+{
+    return rSrc == rDest ||
+        regionNextHop_[rSrc * numRegions_ + rDest] != noRoute;
+}
+
+void RegionMap::generateObstacles()
+{
+    std::uniform_real_distribution<> dist(0, 1);
+    std::vector<double> obstChance;
+
+    // Assign random values to each hex.
+    generate_n(std::back_inserter(obstChance), mgrid_.size(),
+               [&] { return dist(randomGenerator()); });
+
+    // Relaxation step - replace each hex with the average of its neighbors.
+    for (auto i = 0u; i < obstChance.size(); ++i) {
+        double sum = 0.0;
+        auto neighbors = mgrid_.aryNeighbors(i);
+        for (auto n : neighbors) {
+            sum += obstChance[n];
+        }
+
+        // Any hex above the threshold gets an obstacle.
+        if (sum / neighbors.size() > 0.58) {  // TODO: make this configurable?
+            obst_[i] = 1;
+        }
+    }
+
+    mapChanged();
+}
+
+void RegionMap::makeWalkable()
+{
+    std::vector<char> reachable(numRegions_, 0);
+
+    // Ensure every region can reach at least one other region.  Clear the
+    // first pair of hexes we see from each region and a neighboring region.
+    for (int i = 0; i < regions_.size(); ++i) {
+        auto reg = regions_[i];
+        if (reachable[reg] == 1) continue;
+
+        for (const auto &n : mgrid_.aryNeighbors(i)) {
+            auto rNeighbor = regions_[n];
+            if (rNeighbor == reg) continue;
+
+            obst_[i] = 0;
+            obst_[n] = 0;
+            reachable[reg] = 1;
+            break;
+        }
+    }
+
+    // Build a list of walkable hexes in each region.
+    std::vector<std::vector<int>> walkByReg(numRegions_);
+    for (int i = 0; i < regions_.size(); ++i) {
+        if (walkable(i)) {
+            auto r = regions_[i];
+            walkByReg[r].push_back(i);
+        }
+    }
+
+    // Keep track of all hexes we can reach through multiple function calls.
+    std::vector<char> visited(regions_.size(), 0);
+
+    for (auto i = 0; i < numRegions_; ++i) {
+        if (!walkByReg[i].empty()) {
+            makeRegionWalkable(walkByReg[i], visited);
+        }
+    }
+
+    mapChanged();
+}
+
+void RegionMap::makeRegionWalkable(const std::vector<int> &hexes,
+                                   std::vector<char> &visited)
+{
+    // Helper function that lists all neighbors of a hex within the same
+    // region.
+    auto nbrsSameReg = [this] (int aIndex, NeighborList &nbrs) {
+        for (auto d : Dir()) {
+            auto n = mgrid_.aryGetNeighbor(aIndex, d);
+            if (n != -1 && regions_[n] == regions_[aIndex]) {
+                nbrs.push_back(n);
+            }
+        }
+    };
+
+    // Breadth-first search from a walkable hex, marking hexes as we queue
+    // them so each one is queued only once.
+    std::queue<int> q;
+    NeighborList nbrs;
+    auto explore = [&] (int start) {
+        visited[start] = 1;
+        q.push(start);
+        while (!q.empty()) {
+            auto hex = q.front();
+            q.pop();
+            nbrs.clear();
+            nbrsSameReg(hex, nbrs);
+            for (auto n : nbrs) {
+                if (walkable(n) && visited[n] == 0) {
+                    visited[n] = 1;
+                    q.push(n);
+                }
+            }
+        }
+    };
+
+    // Starting from a hex we couldn't reach, find a path to the nearest
+    // walkable hex already visited in this region.
+    auto pf = makePathfinder(nbrsSameReg, UnitStepCost(), ZeroEstimate(),
+        [this, &visited] (int node) {
+            return visited[node] == 1 && walkable(node);
+        });
+
+    // If the region is open, we should reach every hex from the first one.
+    // For each hex we didn't reach, clear a path to it and explore whatever
+    // else that opens up.
+    explore(hexes[0]);
+    for (auto hex : hexes) {
+        if (visited[hex] == 1) continue;
+
+        auto path = pf.getPathFrom(hex, hexScratch_);
+        for (auto n : path) {
+            obst_[n] = 0;
+        }
+        explore(hex);
+    }
+}
+
+void RegionMap::mapChanged()
+{
+    ++mapVersion_;
+}
+
+std::vector<int> RegionMap::buildPath(int aSrc, int aDest,
+                                      std::vector<PathStats> *legStats) const
+{
+    if (aSrc == aDest) {
+        return {aSrc};
+    }
+
+    // Give each search its own stats, if anyone's counting.
+    auto nextLeg = [legStats] () -> PathStats * {
+        if (!legStats) return nullptr;
+        legStats->emplace_back();
+        return &legStats->back();
+    };
+
+    if (pathIndex_) {
+        auto stats = nextLeg();
+        return stats ?
+            pathIndex_->getPath(aSrc, aDest, hexScratch_, revScratch_, *stats) :
+            pathIndex_->getPath(aSrc, aDest, hexScratch_, revScratch_);
+    }
+
+    if (regions_[aSrc] == regions_[aDest]) {
+        // If an obstacle has cut the region in two, the way from one piece
+        // to the other is through the portals.
+        auto path = getPath(aSrc, aDest, nextLeg());
+        if (!path.empty()) return path;
+    }
+    else if (!canReach(regions_[aSrc], regions_[aDest])) {
+        // Don't bother searching if the routing table already knows there's
+        // no way through.
+        return {};
+    }
+    else if (pathMode_ == PathMode::Corridor) {
+        auto path = getCorridorPath(aSrc, aDest, nextLeg());
+        if (!path.empty()) return path;
+    }
+
+    // An obstacle might have cut a region in two, leaving the portals with no
+    // way from one piece to the other.  The hexes are connected, so there's a
+    // path somewhere.
+    auto portalPath = getPortalPath(aSrc, aDest, nextLeg());
+    if (portalPath.empty()) return getMapPath(aSrc, aDest, nextLeg());
+
+    // Fill in the path between each pair of portals in the same region.
+    std::vector<int> path = {aSrc};
+    for (auto i = 1u; i < portalPath.size(); ++i) {
+        auto cur = path.back();
+        auto next = portalPath[i];
+        if (areNeighbors(mgrid_, cur, next)) {
+            path.push_back(next);
+            continue;
+        }
+
+        auto leg = getPath(cur, next, nextLeg());
+        assert(leg.size() > 1);
+        path.insert(std::end(path), std::begin(leg) + 1, std::end(leg));
+    }
+    return path;
+}
+
+std::vector<int> RegionMap::getPortalPath(int aSrc, int aDest,
+                                          PathStats *stats) const
+{
+    auto rSrc = regions_[aSrc];
+    auto rDest = regions_[aDest];
+    auto nbrs = [=] (int curNode, NeighborList &out) {
+        portalNeighbors(curNode, rSrc, rDest, out);
+    };
+    auto cost = [this] (int a, int b) { return portalStepCost(a, b); };
+    auto estimate = [this, aDest] (int aIndex) {
+        return estimateDist(aIndex, aDest);
+    };
+
+    auto pf = makePathfinder(nbrs, cost, estimate, GoalNode(aDest));
+    return stats ? pf.getPathFrom(aSrc, hexScratch_, *stats) :
+        pf.getPathFrom(aSrc, hexScratch_);
+}
+
+std::vector<int> RegionMap::getPath(int aSrc, int aDest,
+                                    PathStats *stats) const
+{
+    assert(regions_[aSrc] == regions_[aDest]);
+
+    // Every step costs the same, so paths within a region can use jump point
+    // search.
+    if (aSrc != aDest && !walkable(aSrc)) return {};
+    return stats ? jumpPf_->getPath(aSrc, aDest, hexScratch_, *stats) :
+        jumpPf_->getPath(aSrc, aDest, hexScratch_);
+}
+
+std::vector<int> RegionMap::getCorridorPath(int aSrc, int aDest,
+                                            PathStats *stats) const
+{
+    auto inCorridor = corridor(regions_[aSrc], regions_[aDest]);
+    auto nbrs = [this, &inCorridor] (int curNode, NeighborList &out) {
+        for (auto d : Dir()) {
+            auto n = mgrid_.aryGetNeighbor(curNode, d);
+            if (n != -1 && inCorridor[regions_[n]] && walkable(n)) {
+                out.push_back(n);
+            }
+        }
+    };
+    auto estimate = [this, aDest] (int aIndex) {
+        return estimateDist(aIndex, aDest);
+    };
+
+    auto pf = makePathfinder(nbrs, UnitStepCost(), estimate, GoalNode(aDest));
+    return stats ? pf.getPathFrom(aSrc, hexScratch_, *stats) :
+        pf.getPathFrom(aSrc, hexScratch_);
+}
+
+std::vector<int> RegionMap::getMapPath(int aSrc, int aDest,
+                                       PathStats *stats) const
+{
+    auto nbrs = [this] (int curNode, NeighborList &out) {
+        for (auto d : Dir()) {
+            auto n = mgrid_.aryGetNeighbor(curNode, d);
+            if (n != -1 && walkable(n)) {
+                out.push_back(n);
+            }
+        }
+    };
+    auto estimate = [this, aDest] (int aIndex) {
+        return estimateDist(aIndex, aDest);
+    };
+
+    auto pf = makePathfinder(nbrs, UnitStepCost(), estimate, GoalNode(aDest));
+    return stats ? pf.getPathFrom(aSrc, hexScratch_, *stats) :
+        pf.getPathFrom(aSrc, hexScratch_);
+}
+
+std::vector<bool> RegionMap::corridor(int rSrc, int rDest) const
+{
+    // Including the neighbors gives the path room to cut corners.
+    std::vector<bool> inCorridor(numRegions_, false);
+    for (auto reg : getRegionRoute(rSrc, rDest)) {
+        inCorridor[reg] = true;
+        for (auto n : regionLinks_[reg]) {
+            inCorridor[n] = true;
+        }
+    }
+    return inCorridor;
+}
+
+void RegionMap::portalNeighbors(int aIndex, int rSrc, int rDest,
+                                NeighborList &nbrs) const
+{
+    // Near either end of the path, walk from hex to hex.
+    auto reg = regions_[aIndex];
+    if (reg == rSrc || reg == rDest) {
+        for (auto d : Dir()) {
+            auto n = mgrid_.aryGetNeighbor(aIndex, d);
+            if (n != -1 && walkable(n) &&
+                (regions_[n] == rSrc || regions_[n] == rDest))
+            {
+                nbrs.push_back(n);
+            }
+        }
+    }
+
+    // Everywhere else, jump between portals.
+    auto p = portalIndex_[aIndex];
+    if (p != -1) {
+        for (const auto &e : portalEdges_[p]) {
+            nbrs.push_back(e.aIndex);
+        }
+    }
+}
+
+int RegionMap::estimateDist(int aIndex, int aDest) const
+{
+    if (landmarks_) {
+        return landmarks_->estimate(aIndex, aDest);
+    }
+    return hexDist(mgrid_.hexFromAry(aIndex), mgrid_.hexFromAry(aDest));
+}
+
+int RegionMap::portalStepCost(int a, int b) const
+{
+    if (areNeighbors(mgrid_, a, b)) return 1;
+
+    const auto &edges = portalEdges_[portalIndex_[a]];
+    auto e = find_if(std::begin(edges), std::end(edges),
+                     [b] (const PortalEdge &pe) { return pe.aIndex == b; });
+    assert(e != std::end(edges));
+    return e->cost;
+}
+
+RegionMap::LegSearch RegionMap::slicedPortalPath(int aSrc, int aDest)
+{
+    auto rSrc = regions_[aSrc];
+    auto rDest = regions_[aDest];
+    auto nbrs = [=] (int curNode, NeighborList &out) {
+        portalNeighbors(curNode, rSrc, rDest, out);
+    };
+    auto cost = [this] (int a, int b) { return portalStepCost(a, b); };
+    auto estimate = [this, aDest] (int aIndex) {
+        return estimateDist(aIndex, aDest);
+    };
+    return legSearch(makeSlicedPathfinder(nbrs, cost, estimate,
+                                          GoalNode(aDest), aSrc,
+                                          sliceScratch_));
+}
+
+RegionMap::LegSearch RegionMap::slicedPath(int aSrc, int aDest)
+{
+    auto reg = regions_[aSrc];
+    assert(regions_[aDest] == reg);
+
+    // Jump point search can't stop partway through, so paths within a region
+    // use A*.
+    auto nbrs = [this, reg] (int curNode, NeighborList &out) {
+        for (auto d : Dir()) {
+            auto n = mgrid_.aryGetNeighbor(curNode, d);
+            if (n != -1 && regions_[n] == reg && walkable(n)) {
+                out.push_back(n);
+            }
+        }
+    };
+    auto estimate = [this, aDest] (int aIndex) {
+        return estimateDist(aIndex, aDest);
+    };
+    return legSearch(makeSlicedPathfinder(nbrs, UnitStepCost(), estimate,
+                                          GoalNode(aDest), aSrc,
+                                          sliceScratch_));
+}
+
+RegionMap::LegSearch RegionMap::slicedCorridorPath(int aSrc, int aDest)
+{
+    // The search outlives this function, so it keeps its own copy of the
+    // corridor.
+    auto inCorridor = corridor(regions_[aSrc], regions_[aDest]);
+    auto nbrs = [this, inCorridor] (int curNode, NeighborList &out) {
+        for (auto d : Dir()) {
+            auto n = mgrid_.aryGetNeighbor(curNode, d);
+            if (n != -1 && inCorridor[regions_[n]] && walkable(n)) {
+                out.push_back(n);
+            }
+        }
+    };
+    auto estimate = [this, aDest] (int aIndex) {
+        return estimateDist(aIndex, aDest);
+    };
+    return legSearch(makeSlicedPathfinder(nbrs, UnitStepCost(), estimate,
+                                          GoalNode(aDest), aSrc,
+                                          sliceScratch_));
+}
+
+RegionMap::LegSearch RegionMap::slicedMapPath(int aSrc, int aDest)
+{
+    auto nbrs = [this] (int curNode, NeighborList &out) {
+        for (auto d : Dir()) {
+            auto n = mgrid_.aryGetNeighbor(curNode, d);
+            if (n != -1 && walkable(n)) {
+                out.push_back(n);
+            }
+        }
+    };
+    auto estimate = [this, aDest] (int aIndex) {
+        return estimateDist(aIndex, aDest);
+    };
+    return legSearch(makeSlicedPathfinder(nbrs, UnitStepCost(), estimate,
+                                          GoalNode(aDest), aSrc,
+                                          sliceScratch_));
+}
+
+void RegionMap::finishLeg(const std::vector<int> &leg)
+{
+    auto &req = request_;
+    req.leg = nullptr;
+    if (collectStats_) {
+        req.pathStats.push_back(req.legStats);
+        req.legStats = PathStats();
+    }
+    if (leg.empty() && req.restricted) {
+        req.restricted = false;
+        req.portalPath.clear();
+        req.leg = slicedPortalPath(req.aSrc, req.aDest);
+        return;
+    }
+    req.restricted = false;
+    if (leg.empty() && req.portalPath.empty()) {
+        // Same as buildPath(), the portals found no way through but there is
+        // one.
+        req.portalPath = {req.aSrc, req.aDest};
+        req.nextStep = 2;
+        req.leg = slicedMapPath(req.aSrc, req.aDest);
+        return;
+    }
+    if (leg.empty()) {
+        req.path.clear();
+        return;
+    }
+
+    // Same steps as buildPath(): the first leg between regions is the search
+    // through the portals, then fill in the path between each pair of
+    // portals in turn.
+    if (req.portalPath.empty()) {
+        req.portalPath = leg;
+        req.nextStep = 1;
+    }
+    else {
+        req.path.insert(std::end(req.path), std::begin(leg) + 1,
+                        std::end(leg));
+    }
+
+    while (req.nextStep < req.portalPath.size()) {
+        auto cur = req.path.back();
+        auto next = req.portalPath[req.nextStep];
+        ++req.nextStep;
+        if (!areNeighbors(mgrid_, cur, next)) {
+            req.leg = slicedPath(cur, next);
+            return;
+        }
+        req.path.push_back(next);
+    }
+}
@@ -0,0 +1,305 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#ifndef REGION_MAP_H
+#define REGION_MAP_H
+
+#include "BasicPathfinder.h"
+#include "ComponentLabels.h"
+#include "ContractionHierarchy.h"
+#include "HexGrid.h"
+#include "HexLayer.h"
+#include "JumpPathfinder.h"
+#include "Landmarks.h"
+#include "PathCache.h"
+#include "PathStats.h"
+#include "SlicedPathfinder.h"
+#include "hex_utils.h"
+#include "terrain.h"
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// The parts of the random map that don't need a screen: regions, obstacles,
+// and finding paths across them.  RandomMap draws one of these.  On its own,
+// it can generate maps and find paths on a machine with no video.
+class RegionMap
+{
+public:
+    // Generate a map using the shared random number generator (see algo.h).
+    // Seed that first for a repeatable map.  Minimum size is 2x1.  Path
+    // searches estimate distances using the given number of landmarks (see
+    // Landmarks.h), or straight-line distance if zero.
+    RegionMap(int hWidth, int hHeight, int numRegions = 18,
+              int numLandmarks = 8);
+
+    const HexGrid & grid() const;
+    int numRegions() const;
+    int region(int aIndex) const;
+
+    // Regions that share a border, whether or not you can walk across it.
+    const AdjacencyList & regionGraph() const;
+
+    // Number of portal hexes in the abstract graph used for long paths.
+    int numPortals() const;
+
+    // Shortest route between two regions by number of borders crossed,
+    // including both ends.  Empty if you can't walk from one to the other.
+    std::vector<int> getRegionRoute(int rSrc, int rDest) const;
+
+    // Return true if the given hex doesn't have an obstacle.
+    bool walkable(int aIndex) const;
+    bool walkable(const Point &hex) const;
+
+    // Add or remove an obstacle after the map is generated.  Only the parts of
+    // the path data near the hex get rebuilt: the portals along the borders
+    // it's on, and the distances between portals in the regions around it.
+    // Blocking a hex can cut a region in two.  The portals don't know a way
+    // from one piece to the other, so paths between them take a search of the
+    // whole map.  Drops the path index, if there is one.
+    void setObstacle(int aIndex, bool present);
+
+    // Once the obstacles are settled, optionally index the map so that every
+    // path after that is exact and found without searching region by region
+    // (see ContractionHierarchy.h).  Takes a while on a big map.  Null if
+    // there's no index.
+    void buildPathIndex();
+    const ContractionHierarchy * getPathIndex() const;
+
+    // Find a path between two walkable hexes.  Paths between regions first
+    // find the portals to pass through, then the path between each pair of
+    // portals.  Empty if either hex has an obstacle, or right away if there's
+    // no way from one to the other.  Paths are cached, so asking for the same
+    // ones over and over is cheap.
+    std::vector<int> findPath(int aSrc, int aDest);
+    const PathCache & getPathCache() const;
+
+    // How to find paths between regions.  Portals, the default, searches
+    // the portal graph and then fills in the path between each pair of
+    // portals.  Corridor does a single A* search that stays within the
+    // regions along the route from getRegionRoute(), plus the regions next to
+    // them.  That's usually faster and the path is usually the shortest, but
+    // a route that has to double back makes for a long search.  Maps with a
+    // path index ignore this.
+    enum class PathMode {Portals, Corridor};
+    void setPathMode(PathMode mode);
+
+    // Optionally record how much work each search did while finding the last
+    // path, one entry per leg.  The search through the portals comes first.
+    // Empty if stats are off or the path came from the cache.
+    void setCollectStats(bool enabled);
+    const std::vector<PathStats> & getPathStats() const;
+
+    // Time-sliced version of findPath(), to keep hard paths from stalling a
+    // frame.  Start finding a path, replacing any request still pending, and
+    // updatePath() does the work a slice at a time.  Return true if the path
+    // is already known.  Once a request finishes, getPathStats() covers it,
+    // each leg added up over all the slices it took.
+    bool requestPath(int aSrc, int aDest);
+
+    // Work on the pending request until it's done or the budget runs out.
+    // Return true if it's done.
+    bool updatePath(SliceBudget &budget);
+    bool pathPending() const;
+
+    // The path from the last request to finish.
+    const std::vector<int> & getRequestedPath() const;
+
+private:
+    // Use a Voronoi diagram to generate a random set of regions.
+    void generateRegions();
+    void recalcHexCenters();
+
+    // Construct an adjacency list for each region.
+    void buildRegionGraph();
+
+    // Choose the portals along each region border and link them up, replacing
+    // any from before.
+    void buildPortalGraph();
+
+    // Redo the portals after the given hex opens up or gets blocked, and the
+    // region routes if that added or removed a link between two regions.
+    void updatePortals(int aIndex);
+
+    // Put portals along the border between two regions, lower numbered first.
+    void placePortals(int rFirst, int rSecond);
+
+    // Link each portal in a region to the others, replacing the old links.
+    void linkPortals(int reg);
+    void linkPortal(int aIndex);
+
+    // Fix the links within a region after one of its hexes opens up or gets
+    // blocked, when that doesn't move any portals.
+    void relinkPortals(int aIndex);
+
+    // Return the portal number for a hex, making it a portal if it isn't
+    // already.
+    int addPortal(int aIndex);
+    void removePortal(int aIndex);
+
+    // Fill in the region routing table from the portal graph.
+    void buildRegionRoutes();
+
+    // Add or remove the link between two regions, and redo the routes that
+    // might change because of it.
+    void setRegionLink(int rFirst, int rSecond, bool linked);
+
+    // Fill in the routes from every region to the given one.
+    void routeTo(int rDest);
+    bool canReach(int rSrc, int rDest) const;
+
+    void generateObstacles();
+
+    // Ensure all walkable hexes in each region are reachable from every other
+    // walkable hex.
+    void makeWalkable();
+    void makeRegionWalkable(const std::vector<int> &hexes,
+                            std::vector<char> &visited);
+
+    // Invalidate anything computed from the obstacles, the regions, or the
+    // region graphs.
+    void mapChanged();
+
+    // Full path between any two walkable hexes, region by region.
+    std::vector<int> buildPath(int aSrc, int aDest,
+                               std::vector<PathStats> *legStats) const;
+
+    // If given stats, each of these search functions adds to them.
+
+    // Return the shortest path between two hexes in different regions,
+    // walking hex by hex within the source and destination regions and
+    // jumping between portals everywhere else.  Consecutive hexes that aren't
+    // neighbors are portals in the same region.
+    std::vector<int> getPortalPath(int aSrc, int aDest,
+                                   PathStats *stats = nullptr) const;
+
+    // Return the shortest path between two hexes in the same region.
+    std::vector<int> getPath(int aSrc, int aDest,
+                             PathStats *stats = nullptr) const;
+
+    // Return the shortest path between two hexes that stays within the
+    // corridor between their regions.
+    std::vector<int> getCorridorPath(int aSrc, int aDest,
+                                     PathStats *stats = nullptr) const;
+
+    // Return the shortest path between two hexes, going anywhere on the map.
+    // The last resort when the searches above come up empty.
+    std::vector<int> getMapPath(int aSrc, int aDest,
+                                PathStats *stats = nullptr) const;
+
+    // Which regions are in the corridor between two regions.
+    std::vector<bool> corridor(int rSrc, int rDest) const;
+
+    // Graph searched by getPortalPath().
+    void portalNeighbors(int aIndex, int rSrc, int rDest,
+                         NeighborList &nbrs) const;
+    int portalStepCost(int a, int b) const;
+
+    // A* estimate for all the searches.
+    int estimateDist(int aIndex, int aDest) const;
+
+    // Resumable search for one leg of a requested path.  Return true once
+    // it's done, with the path (empty if none) in the second argument.
+    // Add counts of the work done to the stats, if given.
+    using LegSearch = std::function<bool (SliceBudget &, std::vector<int> &,
+                                          PathStats *)>;
+
+    // Time-sliced versions of the searches above.
+    LegSearch slicedPortalPath(int aSrc, int aDest);
+    LegSearch slicedPath(int aSrc, int aDest);
+    LegSearch slicedCorridorPath(int aSrc, int aDest);
+    LegSearch slicedMapPath(int aSrc, int aDest);
+
+    // Add a finished leg to the requested path and start the next one.
+    void finishLeg(const std::vector<int> &leg);
+
+    HexGrid mgrid_;
+    int numRegions_;
+    LinearLayer<int> regions_;  // assign each tile to a region [0,numRegions)
+    std::vector<Point> centers_;  // center hex of each region
+    AdjacencyList regionGraph_;
+    std::vector<char> obst_;  // 1=obstacle present, 0=none
+    std::unique_ptr<ComponentLabels> areas_;  // which hexes are connected
+
+    // Hexes along the border between each pair of regions, on the side of the
+    // lower numbered region.
+    std::map<std::pair<int, int>, std::vector<int>> borders_;
+
+    // Abstract graph of walkable hexes along the region borders.  Each portal
+    // links to its partner across the border at cost 1, and to every other
+    // portal it can reach in its region at the length of the shortest path
+    // between them.
+    struct PortalEdge
+    {
+        int aIndex;
+        int cost;
+    };
+    std::vector<int> portalIndex_;  // for each hex, -1 if not a portal
+    std::vector<std::vector<PortalEdge>> portalEdges_;
+    std::vector<int> freePortals_;  // portal numbers no longer in use
+    std::vector<std::vector<int>> regionPortals_;  // portal hexes by region
+
+    // Working memory for placing and linking portals, cleared after each use.
+    std::vector<char> onBorder_;
+    std::vector<int> stepDist_;
+
+    // Regions you can walk to directly from each region, and for each pair of
+    // regions (source * numRegions + dest), the next region along the
+    // shortest route.  Hops are stored as indexes into the source region's
+    // list of links, so each one fits in a byte no matter how many regions
+    // there are.
+    AdjacencyList regionLinks_;
+    std::vector<unsigned char> regionNextHop_;
+
+    // Pathfinder working memory, reused across searches.
+    mutable PathScratch hexScratch_;
+
+    // Built once the obstacles are placed.  Paths stay within one region.
+    std::unique_ptr<JumpPathfinder> jumpPf_;
+    int numLandmarks_;
+    std::unique_ptr<Landmarks> landmarks_;
+    std::unique_ptr<ContractionHierarchy> pathIndex_;
+    mutable PathScratch revScratch_;  // second half of index searches
+
+    PathMode pathMode_;
+    unsigned mapVersion_;
+    PathCache pathCache_;
+    bool collectStats_;
+    std::vector<PathStats> pathStats_;
+
+    // Path being found a slice at a time.  Between regions, the first leg is
+    // the search through the portals.
+    struct PathRequest
+    {
+        int aSrc;
+        int aDest;
+        unsigned mapVersion;
+        std::vector<int> portalPath;
+        unsigned nextStep;  // index in portalPath of the next hex to head for
+        std::vector<int> path;  // legs found so far
+        LegSearch leg;  // null if no request is pending
+        bool restricted;  // first try a region or corridor, then portals
+        PathStats legStats;  // leg in progress
+        std::vector<PathStats> pathStats;  // legs finished
+
+        PathRequest() : aSrc(-1), aDest(-1), mapVersion(0), portalPath(),
+            nextStep(0), path(), leg(), restricted(false), legStats(),
+            pathStats() {}
+    };
+    PathRequest request_;
+    std::vector<int> requestedPath_;
+    PathScratch sliceScratch_;
+};
+
+#endif
@@ -0,0 +1,261 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#ifndef SLICED_PATHFINDER_H
+#define SLICED_PATHFINDER_H
+
+#include "BasicPathfinder.h"
+#include "PathStats.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+// How much work a time-sliced search may do before it has to stop, such as
+// the time left in a frame.  Several searches can share one budget.
+class SliceBudget
+{
+public:
+    // Allow up to maxExpansions node expansions and maxTime_ms of wall time,
+    // whichever runs out first.  A negative limit means no limit.
+    SliceBudget(int maxExpansions, double maxTime_ms);
+
+    // Count one node expansion.  Return false instead if the budget is used
+    // up.
+    bool spend();
+    bool exhausted() const;
+    int spent() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    int maxExpansions_;
+    int spent_;
+    bool timed_;
+    Clock::time_point deadline_;
+    bool exhausted_;
+};
+
+// A* search that can stop partway through and pick up where it left off the
+// next time, so a long search can be spread over several frames.  The
+// template parameters are the same as BasicPathfinder's.
+//
+// All the search state lives in the scratch space, which mustn't be used for
+// anything else until the search is done.  Node ids must be dense.
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+class SlicedPathfinder
+{
+public:
+    SlicedPathfinder(Neighbors nbrs, Cost stepCost, Estimate estimate,
+                     Goal goal, int start, PathScratch &scratch);
+
+    // Search until we find the goal, run out of nodes to try, or use up the
+    // budget.  Return true if the search is done.
+    bool resume(SliceBudget &budget);
+
+    // Same as above, but add counts of the work done to the given stats.
+    // Pass the same stats every time to get the totals for the whole search,
+    // which counts as one search no matter how many slices it took.
+    bool resume(SliceBudget &budget, PathStats &stats);
+
+    bool done() const;
+
+    // Return the path found, once the search is done.  Empty if the goal
+    // can't be reached.
+    std::vector<int> getPath() const;
+
+private:
+    template <typename Stats>
+    bool search(SliceBudget &budget, Stats &stats);
+
+    Neighbors neighbors_;
+    Cost stepCost_;
+    Estimate estimate_;
+    Goal goal_;
+    PathScratch *scratch_;
+    int goalSlot_;
+    bool started_;
+    bool done_;
+};
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+SlicedPathfinder<Neighbors, Cost, Estimate, Goal>
+makeSlicedPathfinder(Neighbors nbrs, Cost stepCost, Estimate estimate,
+                     Goal goal, int start, PathScratch &scratch)
+{
+    return {nbrs, stepCost, estimate, goal, start, scratch};
+}
+
+
+inline SliceBudget::SliceBudget(int maxExpansions, double maxTime_ms)
+    : maxExpansions_(maxExpansions),
+    spent_(0),
+    timed_(maxTime_ms >= 0.0),
+    deadline_(Clock::now()),
+    exhausted_(false)
+{
+    if (timed_) {
+        deadline_ += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::milli>(maxTime_ms));
+    }
+}
+
+inline bool SliceBudget::spend()
+{
+    if (exhausted_) return false;
+
+    // Reading the clock costs about as much as expanding a node, so only
+    // check it every so often.
+    if ((maxExpansions_ >= 0 && spent_ >= maxExpansions_) ||
+        (timed_ && spent_ % 16 == 0 && Clock::now() >= deadline_))
+    {
+        exhausted_ = true;
+        return false;
+    }
+
+    ++spent_;
+    return true;
+}
+
+inline bool SliceBudget::exhausted() const
+{
+    return exhausted_;
+}
+
+inline int SliceBudget::spent() const
+{
+    return spent_;
+}
+
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+SlicedPathfinder<Neighbors, Cost, Estimate, Goal>::SlicedPathfinder(
+        Neighbors nbrs, Cost stepCost, Estimate estimate, Goal goal,
+        int start, PathScratch &scratch)
+    : neighbors_(nbrs),
+    stepCost_(stepCost),
+    estimate_(estimate),
+    goal_(goal),
+    scratch_(&scratch),
+    goalSlot_(-1),
+    started_(false),
+    done_(false)
+{
+    assert(start >= 0 && start < scratch.size());
+    scratch.reset();
+    scratch.add(start, -1, 0);
+    if (goal_(start)) {
+        goalSlot_ = start;
+        done_ = true;
+        return;
+    }
+    scratch.openList<OpenListFor<Cost>>().push(start, 0);
+}
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+bool SlicedPathfinder<Neighbors, Cost, Estimate, Goal>::resume(
+    SliceBudget &budget)
+{
+    NoStats stats;
+    return search(budget, stats);
+}
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+bool SlicedPathfinder<Neighbors, Cost, Estimate, Goal>::resume(
+    SliceBudget &budget, PathStats &stats)
+{
+    return search(budget, stats);
+}
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+template <typename Stats>
+bool SlicedPathfinder<Neighbors, Cost, Estimate, Goal>::search(
+    SliceBudget &budget, Stats &stats)
+{
+    if (done_) return true;
+
+    // The start node went on the open list when the search was created.
+    SearchTimer<Stats> timer(stats, !started_);
+    if (!started_) {
+        stats.push(1);
+        started_ = true;
+    }
+
+    auto &scratch = *scratch_;
+    auto &open = scratch.openList<OpenListFor<Cost>>();
+    auto &nbrs = scratch.nbrs_;
+
+    // Same as BasicPathfinder, except for checking the budget before each
+    // node.
+    while (!open.empty()) {
+        if (!budget.spend()) return false;
+
+        auto cur = open.pop();
+        stats.pop();
+        if (goal_(cur)) {
+            goalSlot_ = cur;
+            break;
+        }
+
+        scratch.visited_[cur] = 1;
+        stats.expand();
+        auto curCost = scratch.costSoFar_[cur];
+        nbrs.clear();
+        neighbors_(cur, nbrs);
+        for (auto n : nbrs) {
+            stats.generate();
+            auto newCost = curCost + stepCost_(cur, n);
+            if (scratch.seen(n)) {
+                if (scratch.visited_[n] || newCost >= scratch.costSoFar_[n]) {
+                    continue;
+                }
+                scratch.prev_[n] = cur;
+                scratch.costSoFar_[n] = newCost;
+                open.decreaseKey(n, newCost + estimate_(n));
+                stats.decreaseKey();
+            }
+            else {
+                scratch.add(n, cur, newCost);
+                open.push(n, newCost + estimate_(n));
+                stats.push(open.size());
+            }
+        }
+    }
+
+    done_ = true;
+    return true;
+}
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+bool SlicedPathfinder<Neighbors, Cost, Estimate, Goal>::done() const
+{
+    return done_;
+}
+
+template <typename Neighbors, typename Cost, typename Estimate, typename Goal>
+std::vector<int> SlicedPathfinder<Neighbors, Cost, Estimate, Goal>::getPath()
+    const
+{
+    assert(done_);
+    if (goalSlot_ == -1) {
+        return {};
+    }
+
+    std::vector<int> path;
+    for (auto s = goalSlot_; s != -1; s = scratch_->prev_[s]) {
+        path.push_back(s);
+    }
+    reverse(std::begin(path), std::end(path));
+    return path;
+}
+
+#endif
@@ -0,0 +1,288 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#include "StreamingMap.h"
+
+#include "terrain.h"
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+namespace {
+    const int seedsPerChunk = 4;
+
+    // Chunk plus a one-hex border, so every hex in the chunk has all of its
+    // neighbors at hand while generating.
+    const int apronSize = StreamingMap::chunkSize + 2;
+
+    // Keep each use of the hash function independent of the others.
+    enum Salt {SALT_NOISE, SALT_TERRAIN, SALT_REGION};
+
+    std::uint32_t mix(std::uint32_t h)
+    {
+        h ^= h >> 16;
+        h *= 0x7feb352du;
+        h ^= h >> 15;
+        h *= 0x846ca68bu;
+        h ^= h >> 16;
+        return h;
+    }
+
+    // Random-looking number that depends only on the inputs.
+    std::uint32_t hash(unsigned seed, int x, int y, int salt)
+    {
+        auto h = mix(seed + 0x9e3779b9u * static_cast<std::uint32_t>(salt + 1));
+        h = mix(h ^ static_cast<std::uint32_t>(x));
+        return mix(h + static_cast<std::uint32_t>(y));
+    }
+
+    // Round toward negative infinity so hex -1 lands in chunk -1.
+    int chunkOf(int h)
+    {
+        return (h >= 0 ? h : h - StreamingMap::chunkSize + 1) /
+            StreamingMap::chunkSize;
+    }
+
+    struct RegionSeed
+    {
+        Point hex;
+        long long id;
+    };
+
+    // Region centers for one chunk.  The first is within the middle quarter,
+    // no more than 59 hexes from anywhere in the chunk.  Centers two or more
+    // chunks away are at least 65 hexes off, so the nearest center to any hex
+    // is in its own chunk or one of the eight around it.
+    void chunkSeeds(unsigned seed, int cx, int cy, RegionSeed *out)
+    {
+        const int size = StreamingMap::chunkSize;
+        for (int i = 0; i < seedsPerChunk; ++i) {
+            auto r = hash(seed, cx, cy, SALT_REGION + i);
+            int lx = (r & 0xffff) % size;
+            int ly = (r >> 16) % size;
+            if (i == 0) {
+                lx = size * 3 / 8 + lx % (size / 4);
+                ly = size * 3 / 8 + ly % (size / 4);
+            }
+            out[i].hex = {cx * size + lx, cy * size + ly};
+            out[i].id = (cx * (1LL << 27) + cy) * seedsPerChunk + i;
+        }
+    }
+
+    int regionTerrain(unsigned seed, long long id)
+    {
+        auto r = hash(seed, static_cast<int>(id), static_cast<int>(id >> 32),
+                      SALT_TERRAIN);
+        return r % NUM_TERRAINS;
+    }
+}
+
+StreamingMap::StreamingMap(unsigned seed, int maxChunks)
+    : seed_(seed),
+    maxChunks_(maxChunks),
+    viewChunks_(0),
+    chunks_(),
+    index_(),
+    chunksGenerated_(0)
+{
+}
+
+void StreamingMap::setView(const Point &hNW, const Point &hSE)
+{
+    auto cx0 = chunkOf(hNW.first) - 1;
+    auto cy0 = chunkOf(hNW.second) - 1;
+    auto cx1 = chunkOf(hSE.first) + 1;
+    auto cy1 = chunkOf(hSE.second) + 1;
+
+    // Touching a chunk moves it to the front, so the view is never evicted.
+    viewChunks_ = (cx1 - cx0 + 1) * (cy1 - cy0 + 1);
+    for (int cy = cy0; cy <= cy1; ++cy) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            getChunk(cx, cy);
+        }
+    }
+    evict();
+}
+
+long long StreamingMap::region(const Point &hex)
+{
+    int index;
+    const auto &chunk = getChunk(hex, index);
+    return chunk.regionIds[chunk.regions[index]];
+}
+
+int StreamingMap::terrain(const Point &hex)
+{
+    int index;
+    const auto &chunk = getChunk(hex, index);
+    return chunk.terrain[index];
+}
+
+bool StreamingMap::walkable(const Point &hex)
+{
+    int index;
+    const auto &chunk = getChunk(hex, index);
+    return chunk.obst[index] == 0;
+}
+
+int StreamingMap::numChunks() const
+{
+    return chunks_.size();
+}
+
+int StreamingMap::chunksGenerated() const
+{
+    return chunksGenerated_;
+}
+
+std::size_t StreamingMap::memoryUsed() const
+{
+    std::size_t bytes = 0;
+    for (const auto &chunk : chunks_) {
+        bytes += sizeof(Chunk) +
+            chunk.regionIds.capacity() * sizeof(long long) +
+            chunk.regions.capacity() + chunk.terrain.capacity() +
+            chunk.obst.capacity();
+    }
+    return bytes;
+}
+
+StreamingMap::Key StreamingMap::makeKey(int cx, int cy)
+{
+    return (static_cast<Key>(static_cast<std::uint32_t>(cx)) << 32) |
+        static_cast<std::uint32_t>(cy);
+}
+
+const StreamingMap::Chunk & StreamingMap::getChunk(const Point &hex,
+                                                   int &index)
+{
+    assert(hex != hInvalid);
+    auto cx = chunkOf(hex.first);
+    auto cy = chunkOf(hex.second);
+    index = (hex.second - cy * chunkSize) * chunkSize +
+        (hex.first - cx * chunkSize);
+    return getChunk(cx, cy);
+}
+
+const StreamingMap::Chunk & StreamingMap::getChunk(int cx, int cy)
+{
+    auto key = makeKey(cx, cy);
+    auto iter = index_.find(key);
+    if (iter != std::end(index_)) {
+        chunks_.splice(std::begin(chunks_), chunks_, iter->second);
+        return chunks_.front();
+    }
+
+    chunks_.emplace_front();
+    auto &chunk = chunks_.front();
+    chunk.key = key;
+    generate(cx, cy, chunk);
+    ++chunksGenerated_;
+    index_[key] = std::begin(chunks_);
+
+    // The new chunk is at the front, so this can't take it away.
+    evict();
+    return chunk;
+}
+
+void StreamingMap::generate(int cx, int cy, Chunk &chunk) const
+{
+    // Region centers for this chunk and two more in every direction, enough
+    // to cover the neighborhood of any hex in the apron.
+    RegionSeed seeds[5][5][seedsPerChunk];
+    for (int dy = 0; dy < 5; ++dy) {
+        for (int dx = 0; dx < 5; ++dx) {
+            chunkSeeds(seed_, cx + dx - 2, cy + dy - 2, seeds[dy][dx]);
+        }
+    }
+
+    auto x0 = cx * chunkSize - 1;
+    auto y0 = cy * chunkSize - 1;
+    std::vector<long long> apronRegion(apronSize * apronSize);
+    std::vector<double> apronNoise(apronSize * apronSize);
+    for (int ay = 0; ay < apronSize; ++ay) {
+        for (int ax = 0; ax < apronSize; ++ax) {
+            Point hex = {x0 + ax, y0 + ay};
+            auto i = ay * apronSize + ax;
+
+            // Nearest center among the hex's own chunk and those around it.
+            // Ties go to the lower id so every chunk agrees.
+            auto hcx = chunkOf(hex.first) - cx + 2;
+            auto hcy = chunkOf(hex.second) - cy + 2;
+            auto bestDist = int_max;
+            long long best = 0;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    for (const auto &s : seeds[hcy + dy][hcx + dx]) {
+                        auto dist = hexDist(hex, s.hex);
+                        if (dist < bestDist ||
+                            (dist == bestDist && s.id < best)) {
+                            bestDist = dist;
+                            best = s.id;
+                        }
+                    }
+                }
+            }
+            apronRegion[i] = best;
+            apronNoise[i] = hash(seed_, hex.first, hex.second, SALT_NOISE) /
+                4294967296.0;
+        }
+    }
+
+    const int numHexes = chunkSize * chunkSize;
+    chunk.regionIds.clear();
+    chunk.regions.assign(numHexes, 0);
+    chunk.terrain.assign(numHexes, 0);
+    chunk.obst.assign(numHexes, 0);
+    std::vector<int> regionTerrains;
+
+    for (int ly = 0; ly < chunkSize; ++ly) {
+        for (int lx = 0; lx < chunkSize; ++lx) {
+            auto index = ly * chunkSize + lx;
+            auto id = apronRegion[(ly + 1) * apronSize + lx + 1];
+
+            auto r = std::find(std::begin(chunk.regionIds),
+                               std::end(chunk.regionIds), id) -
+                std::begin(chunk.regionIds);
+            if (r == static_cast<int>(chunk.regionIds.size())) {
+                chunk.regionIds.push_back(id);
+                regionTerrains.push_back(regionTerrain(seed_, id));
+            }
+            chunk.regions[index] = r;
+            chunk.terrain[index] = regionTerrains[r];
+
+            // Same relaxation as RegionMap: average the neighbors' noise.
+            // Region borders stay clear so neighboring regions connect.
+            Point hex = {x0 + lx + 1, y0 + ly + 1};
+            double sum = 0.0;
+            bool border = false;
+            for (auto d : Dir()) {
+                auto n = adjacent(hex, d);
+                auto ai = (n.second - y0) * apronSize + (n.first - x0);
+                sum += apronNoise[ai];
+                border = border || apronRegion[ai] != id;
+            }
+            if (!border && sum / 6 > 0.58) {
+                chunk.obst[index] = 1;
+            }
+        }
+    }
+}
+
+void StreamingMap::evict()
+{
+    auto limit = std::max(maxChunks_, viewChunks_);
+    while (static_cast<int>(chunks_.size()) > limit) {
+        index_.erase(chunks_.back().key);
+        chunks_.pop_back();
+    }
+}
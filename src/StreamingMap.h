@@ -0,0 +1,97 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#ifndef STREAMING_MAP_H
+#define STREAMING_MAP_H
+
+#include "hex_utils.h"
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// Endless random map, generated in 64x64 hex chunks as the view gets near
+// them.  Hex coordinates can be anything, including negative.
+//
+// RegionMap needs the whole grid at once to relax its regions and make sure
+// every one can be reached.  Here everything about a hex comes from the seed
+// and its coordinates alone, so a chunk can be built without its neighbors and
+// rebuilt exactly the same after it's been thrown away:
+// - Each chunk scatters a few region centers from a hash of the seed and the
+//   chunk coordinates, and every hex belongs to the nearest one.  The first
+//   center is near the middle of the chunk, which keeps the nearest center
+//   within the chunks right around the hex, so regions run smoothly across
+//   chunk borders.
+// - Terrain is hashed from the region.
+// - Obstacles use the same smoothed noise as RegionMap, hashed per hex.  Hexes
+//   along region borders are always walkable, so you can get from any region
+//   to its neighbors.
+//
+// Only the most recently used chunks stay in memory, so memory is bounded no
+// matter how far the view scrolls.
+class StreamingMap
+{
+public:
+    static const int chunkSize = 64;
+
+    // Keep up to maxChunks in memory, more if the view needs them.
+    explicit StreamingMap(unsigned seed, int maxChunks = 64);
+
+    // Make sure the chunks covering the given rectangle of hexes, plus one
+    // more chunk in every direction, are ready.  Then drop the least recently
+    // used chunks over the limit.  Call this whenever the view moves.
+    void setView(const Point &hNW, const Point &hSE);
+
+    // Everything about a given hex.  Its chunk gets generated if it isn't in
+    // memory.  Regions are numbered uniquely across the whole map.
+    long long region(const Point &hex);
+    int terrain(const Point &hex);
+    bool walkable(const Point &hex);
+
+    int numChunks() const;
+
+    // Number of chunks built since the map was created, including any that
+    // were dropped and built again.
+    int chunksGenerated() const;
+
+    // Bytes of chunk data in memory.
+    std::size_t memoryUsed() const;
+
+private:
+    using Key = std::uint64_t;
+
+    struct Chunk
+    {
+        Key key;
+        std::vector<long long> regionIds;  // regions with hexes in this chunk
+        std::vector<char> regions;  // index into regionIds for each hex
+        std::vector<char> terrain;
+        std::vector<char> obst;  // 1=obstacle present, 0=none
+    };
+
+    static Key makeKey(int cx, int cy);
+
+    // Return the chunk containing a hex and the hex's index within it.
+    const Chunk & getChunk(const Point &hex, int &index);
+    const Chunk & getChunk(int cx, int cy);
+    void generate(int cx, int cy, Chunk &chunk) const;
+    void evict();
+
+    unsigned seed_;
+    int maxChunks_;
+    int viewChunks_;
+    std::list<Chunk> chunks_;  // most recently used first
+    std::unordered_map<Key, std::list<Chunk>::iterator> index_;
+    int chunksGenerated_;
+};
+
+#endif
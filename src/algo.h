@@ -20,7 +20,7 @@
 template <class Container, class T>
 bool contains(const Container &c, const T &elem)
 {
-    return find(std::begin(c), std::end(c), elem) != std::end(c);
+    return std::find(std::begin(c), std::end(c), elem) != std::end(c);
 }
 
 template <class T, class U, class V>
@@ -10,6 +10,7 @@
  
     See the COPYING.txt file for more details.
 */
+#include "FixedHexGrid.h"
 #include "hex_utils.h"
 #include "sdl_helper.h"
 #include <iostream>
@@ -21,10 +22,9 @@ enum class Animating { NONE, BOWMAN, MARSHAL, GRUNT };
 
 namespace
 {
-    const Sint16 width = 5;
-    const Sint16 height = 5;
-    const Sint16 pWidth = pHexSize * 3 / 4 * width + pHexSize / 4;
-    const Sint16 pHeight = pHexSize * height;
+    using Board = FixedHexGrid<5, 5>;
+    const Sint16 pWidth = pHexSize * 3 / 4 * Board::width() + pHexSize / 4;
+    const Sint16 pHeight = pHexSize * Board::height();
     SDL_Rect window = {0, 0, pWidth, pHeight};
 
     SdlSurface tile;
@@ -214,7 +214,7 @@ void handleMouseUp(const SDL_MouseButtonEvent &event)
 // Draw a 5-hex wide hexagonal grid.
 void drawHexGrid()
 {
-    for (int x = 0; x < 5; ++x) {
+    for (int x = 0; x < Board::width(); ++x) {
         for (int y = 1; y < 4; ++y) {
             sdlBlit(tile, pixelFromHex(x, y));
         }
@@ -41,28 +41,35 @@ std::string str(const Point &p)
 }
 
 // source: Battle for Wesnoth, distance_between() in map_location.cpp.
-Sint16 hexDist(const Point &h1, const Point &h2)
+int hexDist(const Point &h1, const Point &h2)
 {
     if (h1 == hInvalid || h2 == hInvalid) {
-        return Sint16_max;
+        return int_max;
     }
 
-    Sint16 dx = abs(h1.first - h2.first);
-    Sint16 dy = abs(h1.second - h2.second);
+    int dx = abs(h1.first - h2.first);
+    int dy = abs(h1.second - h2.second);
 
     // Since the x-axis of the hex grid is staggered, we need to add a step in
-    // certain cases.
-    Sint16 vPenalty = 0;
-    if ((h1.second < h2.second && h1.first % 2 == 0 && h2.first % 2 == 1) ||
-        (h1.second > h2.second && h1.first % 2 == 1 && h2.first % 2 == 0)) {
+    // certain cases.  Negative odd columns have a remainder of -1.
+    bool odd1 = h1.first % 2 != 0;
+    bool odd2 = h2.first % 2 != 0;
+    int vPenalty = 0;
+    if ((h1.second < h2.second && !odd1 && odd2) ||
+        (h1.second > h2.second && odd1 && !odd2)) {
         vPenalty = 1;
     }
 
-    return std::max<Sint16>(dx, dy + vPenalty + dx / 2);
+    return std::max(dx, dy + vPenalty + dx / 2);
 }
 
 Point adjacent(const Point &hSrc, Dir d)
 {
+    // Stepping off the invalid hex would overflow.
+    if (hSrc == hInvalid) {
+        return hInvalid;
+    }
+
     auto hx = hSrc.first;
 
     switch (d) {
@@ -107,10 +114,10 @@ int findClosest(const Point &hTarget, const std::vector<Point> &hexes)
 {
     int closest = -1;
     int size = static_cast<int>(hexes.size());
-    Sint16 bestSoFar = Sint16_max;
+    int bestSoFar = int_max;
 
     for (int i = 0; i < size; ++i) {
-        Sint16 dist = hexDist(hTarget, hexes[i]);
+        int dist = hexDist(hTarget, hexes[i]);
         if (dist < bestSoFar) {
             closest = i;
             bestSoFar = dist;
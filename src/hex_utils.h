@@ -23,10 +23,15 @@
 
 const Sint16 Sint16_min = std::numeric_limits<Sint16>::min();
 const Sint16 Sint16_max = std::numeric_limits<Sint16>::max();
+const int int_min = std::numeric_limits<int>::min();
+const int int_max = std::numeric_limits<int>::max();
 
-using Point = std::pair<Sint16, Sint16>;
-const Point hInvalid = {Sint16_min, Sint16_min};
-const Sint16 pHexSize = 72;
+// Hex coordinates and map pixels.  These are 32-bit so maps can be much
+// larger than the screen.  Convert to Sint16 only when handing screen pixels
+// to SDL.
+using Point = std::pair<int, int>;
+const Point hInvalid = {int_min, int_min};
+const int pHexSize = 72;
 
 bool operator==(const Point &lhs, const Point &rhs);
 bool operator!=(const Point &lhs, const Point &rhs);
@@ -51,7 +56,7 @@ enum class Dir {N, NE, SE, S, SW, NW, _last, _first = N};
 ITERABLE_ENUM_CLASS(Dir);
 
 // Distance between hexes, 1 step per tile.
-Sint16 hexDist(const Point &h1, const Point &h2);
+int hexDist(const Point &h1, const Point &h2);
 
 // Return the hex adjancent to the source hex in the given direction.  No
 // bounds checking.
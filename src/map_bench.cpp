@@ -0,0 +1,360 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+
+    See the COPYING.txt file for more details.
+*/
+#include "BasicPathfinder.h"
+#include "HexLayer.h"
+#include "Landmarks.h"
+#include "Pathfinder.h"
+#include "PathStats.h"
+#include "RegionMap.h"
+#include "StreamingMap.h"
+#include "algo.h"
+#include "hex_utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Generate random maps the same way the Random Map demo does, at several
+// sizes, and time a fixed set of queries on each.  Plain A* over the whole map
+// is compared against the region-by-region paths the demo highlights, each with
+// and without landmark estimates, a single search along the route between
+// regions, and the optional path index.  Last, per-hex layers stored row by
+// row are compared against chunked ones on a 1024x1024 map, and an endless
+// streaming map is scrolled a long way to see how chunk generation keeps up.
+// No graphics, so this runs anywhere.
+//
+// Usage: mapbench [seed]
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using Query = std::pair<int, int>;
+
+    const int maxIndexSize = 512 * 512;
+
+    struct Timings
+    {
+        std::vector<double> latency_ms;
+        long long expanded;
+        long long pathLength;
+        int noPath;
+
+        Timings() : latency_ms(), expanded(0), pathLength(0), noPath(0) {}
+    };
+
+    double percentile(const std::vector<double> &sorted, double p)
+    {
+        auto i = static_cast<size_t>(p * sorted.size());
+        return sorted[std::min(i, sorted.size() - 1)];
+    }
+
+    void report(const char *name, Timings t)
+    {
+        auto &lat = t.latency_ms;
+        sort(std::begin(lat), std::end(lat));
+        double total_ms = 0.0;
+        for (auto ms : lat) {
+            total_ms += ms;
+        }
+        auto n = lat.size();
+
+        std::cout << "  " << std::left << std::setw(22) << name << std::right
+            << " p50 " << std::setw(8) << percentile(lat, 0.5)
+            << " p90 " << std::setw(8) << percentile(lat, 0.9)
+            << " p99 " << std::setw(8) << percentile(lat, 0.99)
+            << " ms, " << std::setw(8) << t.expanded / n << " expanded, "
+            << std::setw(8) << n / total_ms * 1000.0 << " queries/s, "
+            << std::setw(6) << t.pathLength / n << " avg length\n";
+        if (t.noPath > 0) {
+            std::cout << "  WARNING: " << t.noPath <<
+                " queries found no path\n";
+        }
+    }
+
+    template <typename Func>
+    Timings timeQueries(const std::vector<Query> &queries, Func f)
+    {
+        Timings t;
+        for (const auto &q : queries) {
+            PathStats stats;
+            auto startTime = Clock::now();
+            auto path = f(q.first, q.second, stats);
+            std::chrono::duration<double, std::milli> elapsed =
+                Clock::now() - startTime;
+
+            t.latency_ms.push_back(elapsed.count());
+            t.expanded += stats.expanded;
+            t.pathLength += path.size();
+            if (path.empty()) ++t.noPath;
+        }
+        return t;
+    }
+
+    Timings timeRegionPaths(const std::vector<Query> &queries,
+                            RegionMap &map)
+    {
+        // Queries hardly ever repeat, so almost none of these come from the
+        // path cache.
+        map.setCollectStats(true);
+        return timeQueries(queries,
+            [&] (int src, int dest, PathStats &stats) {
+                auto path = map.findPath(src, dest);
+                for (const auto &leg : map.getPathStats()) {
+                    stats += leg;
+                }
+                return path;
+            });
+    }
+
+    // Same queries every run for a given seed.
+    std::vector<Query> makeQueries(const RegionMap &map, int numQueries,
+                                   unsigned seed)
+    {
+        std::minstd_rand gen(seed);
+        std::uniform_int_distribution<int> randomHex(0, map.grid().size() - 1);
+        std::vector<Query> queries;
+        while (static_cast<int>(queries.size()) < numQueries) {
+            auto src = randomHex(gen);
+            auto dest = randomHex(gen);
+            if (map.walkable(src) && map.walkable(dest)) {
+                queries.emplace_back(src, dest);
+            }
+        }
+        return queries;
+    }
+
+    void runMap(int width, int height, int numQueries, unsigned seed)
+    {
+        randomGenerator().seed(seed);
+        auto startTime = Clock::now();
+        RegionMap map(width, height);
+        std::chrono::duration<double, std::milli> genTime =
+            Clock::now() - startTime;
+        const auto &grid = map.grid();
+        auto walkable = [&map] (int aIndex) { return map.walkable(aIndex); };
+        auto queries = makeQueries(map, numQueries, seed);
+
+        startTime = Clock::now();
+        Landmarks landmarks(grid, walkable, 8);
+        std::chrono::duration<double, std::milli> landmarkTime =
+            Clock::now() - startTime;
+
+        std::cout << width << "x" << height << " (generated in " <<
+            genTime.count() << " ms, landmarks " << landmarkTime.count() <<
+            " ms, " << numQueries << " queries):\n";
+
+        int aGoal = -1;
+        Pathfinder pf;
+        pf.setNeighbors([&] (int aIndex) {
+            std::vector<int> nbrs;
+            for (auto n : grid.aryNeighbors(aIndex)) {
+                if (walkable(n)) nbrs.push_back(n);
+            }
+            return nbrs;
+        });
+        pf.setStepCost([] (int, int) { return 1; }, 1);
+        pf.setEstimate([&] (int aIndex) {
+            return static_cast<int>(hexDist(grid.hexFromAry(aIndex),
+                                            grid.hexFromAry(aGoal)));
+        });
+        PathScratch scratch(grid.size());
+        auto pathTo = [&] (int src, int dest, PathStats &stats) {
+            aGoal = dest;
+            pf.setGoal(dest);
+            return pf.getPathFrom(src, scratch, stats);
+        };
+        report("Pathfinder A*", timeQueries(queries, pathTo));
+
+        pf.setEstimate([&] (int aIndex) {
+            return landmarks.estimate(aIndex, aGoal);
+        });
+        report("A*, landmarks", timeQueries(queries, pathTo));
+
+        report("Region paths", timeRegionPaths(queries, map));
+        map.setPathMode(RegionMap::PathMode::Corridor);
+        report("Corridor paths", timeRegionPaths(queries, map));
+        map.setPathMode(RegionMap::PathMode::Portals);
+
+        // Same map again, searching with straight-line distance.
+        randomGenerator().seed(seed);
+        RegionMap plainMap(width, height, 18, 0);
+        report("Regions, no landmarks", timeRegionPaths(queries, plainMap));
+
+        // Indexing the biggest map takes longer than everything else here
+        // put together.
+        if (grid.size() > maxIndexSize) {
+            std::cout << "  (no path index at this size)\n";
+            return;
+        }
+        startTime = Clock::now();
+        map.buildPathIndex();
+        std::chrono::duration<double, std::milli> indexTime =
+            Clock::now() - startTime;
+        const auto *index = map.getPathIndex();
+        std::cout << "  path index built in " << indexTime.count() <<
+            " ms, " << index->numShortcuts() << " shortcuts, " <<
+            index->memoryUsed() / 1024 << " KB\n";
+        report("Path index", timeRegionPaths(queries, map));
+    }
+
+    // Copy the map into per-hex layers the way RandomMap keeps terrain and
+    // obstacles.  Scroll a screen-sized view across the whole map a few hexes
+    // at a time, reading both layers, and find paths that check obstacles in
+    // the layer.
+    template <typename TerrainLayer, typename ObstLayer>
+    void timeLayers(const char *name, const RegionMap &map,
+                    const std::vector<Query> &queries)
+    {
+        const auto &grid = map.grid();
+        TerrainLayer terrain(grid);
+        ObstLayer obst(grid);
+        for (int i = 0; i < grid.size(); ++i) {
+            terrain[i] = map.region(i);
+            obst[i] = map.walkable(i) ? 0 : 1;
+        }
+
+        // About 1920x1080 pixels worth of hexes.
+        const int viewWidth = 36;
+        const int viewHeight = 15;
+        const int step = 4;
+        long long checksum = 0;
+        long long numViews = 0;
+        auto startTime = Clock::now();
+        for (int hx = 0; hx + viewWidth <= grid.width(); hx += step) {
+            for (int hy = 0; hy + viewHeight <= grid.height(); hy += step) {
+                Point hNW = {hx, hy};
+                Point hSE = {hx + viewWidth - 1, hy + viewHeight - 1};
+                terrain.forEachInRect(hNW, hSE, [&] (int, int t) {
+                    checksum += t;
+                });
+                obst.forEachInRect(hNW, hSE, [&] (int, char o) {
+                    checksum += o;
+                });
+                ++numViews;
+            }
+        }
+        std::chrono::duration<double, std::micro> viewTime =
+            Clock::now() - startTime;
+        std::cout << "  " << std::left << std::setw(22) << name << std::right
+            << " " << viewTime.count() / numViews << " us per view (" <<
+            checksum << ")\n";
+
+        auto nbrs = [&obst] (int aIndex, NeighborList &out) {
+            obst.forEachNeighbor(aIndex, [&out] (int n, char o) {
+                if (!o) out.push_back(n);
+            });
+        };
+        PathScratch scratch(grid.size());
+        report(name, timeQueries(queries,
+            [&] (int src, int dest, PathStats &stats) {
+                auto hDest = grid.hexFromAry(dest);
+                auto est = [&grid, hDest] (int aIndex) {
+                    return hexDist(grid.hexFromAry(aIndex), hDest);
+                };
+                auto pf = makePathfinder(nbrs, UnitStepCost(), est,
+                                         GoalNode(dest));
+                return pf.getPathFrom(src, scratch, stats);
+            }));
+    }
+
+    void runLayers(int width, int height, int numQueries, unsigned seed)
+    {
+        randomGenerator().seed(seed);
+        RegionMap map(width, height);
+        auto queries = makeQueries(map, numQueries, seed);
+
+        std::cout << width << "x" << height << " layers, " << numQueries <<
+            " queries:\n";
+        timeLayers<LinearLayer<int>, LinearLayer<char>>("Linear layers", map,
+                                                        queries);
+        timeLayers<ChunkedLayer<int>, ChunkedLayer<char>>("Chunked layers",
+                                                          map, queries);
+    }
+
+    // Scroll a demo-sized view across a streaming map, reading every hex in
+    // view each step, the way drawing the map would.
+    void runStreaming(int distance, int maxChunks, unsigned seed)
+    {
+        const int viewWidth = 36;
+        const int viewHeight = 15;
+        StreamingMap map(seed, maxChunks);
+
+        auto startTime = Clock::now();
+        map.setView({0, 0}, {viewWidth - 1, viewHeight - 1});
+        std::chrono::duration<double, std::milli> startup =
+            Clock::now() - startTime;
+        auto startChunks = map.chunksGenerated();
+
+        // Head east, drifting south, one hex per frame.
+        long long checksum = 0;
+        double worstFrame = 0.0;
+        auto peakChunks = map.numChunks();
+        auto peakMemory = map.memoryUsed();
+        startTime = Clock::now();
+        for (int i = 1; i <= distance; ++i) {
+            auto frameStart = Clock::now();
+            Point hNW = {i, i / 4};
+            Point hSE = {i + viewWidth - 1, i / 4 + viewHeight - 1};
+            map.setView(hNW, hSE);
+            for (int hy = hNW.second; hy <= hSE.second; ++hy) {
+                for (int hx = hNW.first; hx <= hSE.first; ++hx) {
+                    checksum += map.terrain({hx, hy}) +
+                        (map.walkable({hx, hy}) ? 0 : 1);
+                }
+            }
+            std::chrono::duration<double, std::milli> frame =
+                Clock::now() - frameStart;
+            worstFrame = std::max(worstFrame, frame.count());
+            peakChunks = std::max(peakChunks, map.numChunks());
+            peakMemory = std::max(peakMemory, map.memoryUsed());
+        }
+        std::chrono::duration<double, std::milli> scrollTime =
+            Clock::now() - startTime;
+        auto numChunks = map.chunksGenerated() - startChunks;
+
+        std::cout << "Streaming map, " << distance << " hexes of scrolling, " <<
+            "up to " << maxChunks << " chunks:\n" <<
+            "  startup " << startup.count() << " ms for " << startChunks <<
+            " chunks, " << startup.count() / startChunks << " ms per chunk\n" <<
+            "  scrolling " << scrollTime.count() / distance <<
+            " ms per frame, worst " << worstFrame << " ms, " << numChunks <<
+            " chunks generated\n" <<
+            "  peak " << peakChunks << " chunks, " << peakMemory / 1024 <<
+            " KB (" << checksum << ")\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned seed = 12345;
+    if (argc > 1) {
+        seed = std::strtoul(argv[1], nullptr, 10);
+    }
+    std::cout << std::fixed << std::setprecision(3);
+
+    // The first size is the one the demo uses.
+    runMap(32, 18, 1000, seed);
+    runMap(128, 128, 500, seed);
+    runMap(256, 256, 200, seed);
+    runMap(512, 512, 100, seed);
+    runMap(1024, 1024, 50, seed);
+    runMap(2048, 2048, 20, seed);
+    runLayers(1024, 1024, 50, seed);
+    runStreaming(20000, 64, seed);
+    return EXIT_SUCCESS;
+}
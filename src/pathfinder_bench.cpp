@@ -0,0 +1,580 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+ 
+    See the COPYING.txt file for more details.
+*/
+#include "BasicPathfinder.h"
+#include "FixedHexGrid.h"
+#include "HexGrid.h"
+#include "IncrementalPathfinder.h"
+#include "JumpPathfinder.h"
+#include "PathService.h"
+#include "Pathfinder.h"
+#include "hex_utils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Compare the Pathfinder open list against the make_heap() version it
+// replaced, on a 256x256 hex grid.  Also time neighbor lookups against the
+// version that went through a Point, BasicPathfinder with inline neighbor
+// functions and with a bucket queue, jump point search on uniform-cost maps,
+// how batch queries scale across threads, replanning as obstacles change, and
+// weighted A*.
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using Query = std::pair<int, int>;
+
+    struct LegacyNode
+    {
+        int prev;
+        int costSoFar;
+        int estTotalCost;
+        bool visited;
+    };
+
+    // The original Pathfinder::getPathFrom(), which rebuilt the whole heap
+    // whenever it found a shorter path to an open node.
+    std::vector<int> makeHeapPath(int start, int goal,
+        const std::function<std::vector<int> (int)> &neighbors,
+        const std::function<int (int, int)> &stepCost,
+        const std::function<int (int)> &estimate)
+    {
+        if (start == goal) return {start};
+
+        std::unordered_map<int, std::shared_ptr<LegacyNode>> nodes;
+        std::vector<int> open;
+        std::shared_ptr<LegacyNode> goalNode;
+
+        auto orderByCost = [&] (int lhs, int rhs)
+        {
+            return nodes[lhs]->estTotalCost > nodes[rhs]->estTotalCost;
+        };
+
+        nodes.emplace(start, std::make_shared<LegacyNode>(
+            LegacyNode{-1, 0, 0, false}));
+        open.push_back(start);
+
+        while (!open.empty()) {
+            auto loc = open.front();
+            pop_heap(std::begin(open), std::end(open), orderByCost);
+            open.pop_back();
+            if (loc == goal) {
+                goalNode = nodes[loc];
+                break;
+            }
+
+            auto &curNode = nodes[loc];
+            curNode->visited = true;
+            for (auto n : neighbors(loc)) {
+                auto nIter = nodes.find(n);
+                auto step = stepCost(loc, n);
+
+                if (nIter != nodes.end()) {
+                    auto &nNode = nIter->second;
+                    if (nNode->visited) continue;
+
+                    if (curNode->costSoFar + step < nNode->costSoFar) {
+                        nNode->prev = loc;
+                        nNode->costSoFar = curNode->costSoFar + step;
+                        nNode->estTotalCost = nNode->costSoFar + estimate(n);
+                        make_heap(std::begin(open), std::end(open),
+                                  orderByCost);
+                    }
+                }
+                else {
+                    nodes.emplace(n, std::make_shared<LegacyNode>(LegacyNode{
+                        loc, curNode->costSoFar + step,
+                        curNode->costSoFar + step + estimate(n), false}));
+                    open.push_back(n);
+                    push_heap(std::begin(open), std::end(open), orderByCost);
+                }
+            }
+        }
+
+        if (!goalNode) return {};
+
+        std::vector<int> path = {goal};
+        auto n = goalNode;
+        while (n->prev != -1) {
+            path.push_back(n->prev);
+            n = nodes[n->prev];
+        }
+        reverse(std::begin(path), std::end(path));
+        return path;
+    }
+
+    // The original HexGrid::aryNeighbors(), which converted the index to a
+    // Point and back for each direction and returned a new vector.
+    std::vector<int> pointNeighbors(const HexGrid &grid, int aIndex)
+    {
+        std::vector<int> av;
+        auto hex = grid.hexFromAry(aIndex);
+        for (auto d : Dir()) {
+            auto neighbor = adjacent(hex, d);
+            if (!grid.offGrid(neighbor)) {
+                av.push_back(grid.aryFromHex(neighbor));
+            }
+        }
+        return av;
+    }
+
+    template <typename Func>
+    double timeQueries_ms(const std::vector<Query> &queries, Func f)
+    {
+        auto startTime = Clock::now();
+        for (const auto &q : queries) {
+            f(q.first, q.second);
+        }
+        std::chrono::duration<double, std::milli> elapsed =
+            Clock::now() - startTime;
+        return elapsed.count() / queries.size();
+    }
+
+    int pathCost(const std::vector<int> &path,
+                 const std::function<int (int, int)> &stepCost)
+    {
+        int cost = 0;
+        for (auto i = 1u; i < path.size(); ++i) {
+            cost += stepCost(path[i - 1], path[i]);
+        }
+        return cost;
+    }
+
+    void runScenario(const char *name, const HexGrid &grid,
+                     const std::vector<char> &obst,
+                     const std::function<int (int, int)> &stepCost,
+                     int maxStepCost,
+                     bool useEstimate,
+                     const std::vector<Query> &queries)
+    {
+        auto neighbors = [&] (int aIndex) {
+            std::vector<int> nbrs;
+            for (auto n : grid.aryNeighbors(aIndex)) {
+                if (!obst[n]) nbrs.push_back(n);
+            }
+            return nbrs;
+        };
+
+        int aGoal = -1;
+        auto estimate = [&] (int aIndex) {
+            if (!useEstimate) return 0;
+            return static_cast<int>(hexDist(grid.hexFromAry(aIndex),
+                                            grid.hexFromAry(aGoal)));
+        };
+
+        Pathfinder pf;
+        pf.setNeighbors(neighbors);
+        pf.setStepCost(stepCost);
+        pf.setEstimate(estimate);
+        PathScratch scratch(grid.size());
+
+        // Make sure all three versions agree before timing them.
+        int mismatches = 0;
+        for (const auto &q : queries) {
+            aGoal = q.second;
+            pf.setGoal(aGoal);
+            auto expected = makeHeapPath(q.first, aGoal, neighbors, stepCost,
+                                         estimate);
+            auto c = pathCost(expected, stepCost);
+            if (pathCost(pf.getPathFrom(q.first), stepCost) != c ||
+                pathCost(pf.getPathFrom(q.first, scratch), stepCost) != c)
+            {
+                ++mismatches;
+            }
+        }
+
+        auto legacy = timeQueries_ms(queries, [&] (int src, int dest) {
+            aGoal = dest;
+            makeHeapPath(src, dest, neighbors, stepCost, estimate);
+        });
+        auto indexed = timeQueries_ms(queries, [&] (int src, int dest) {
+            aGoal = dest;
+            pf.setGoal(dest);
+            pf.getPathFrom(src);
+        });
+        auto dense = timeQueries_ms(queries, [&] (int src, int dest) {
+            aGoal = dest;
+            pf.setGoal(dest);
+            pf.getPathFrom(src, scratch);
+        });
+
+        // Same search with everything inlined and no neighbor vectors.
+        auto inlineNbrs = [&] (int aIndex, NeighborList &nbrs) {
+            for (auto d : Dir()) {
+                auto n = grid.aryGetNeighbor(aIndex, d);
+                if (n != -1 && !obst[n]) nbrs.push_back(n);
+            }
+        };
+        auto inlined = timeQueries_ms(queries, [&] (int src, int dest) {
+            aGoal = dest;
+            auto bpf = makePathfinder(inlineNbrs, stepCost, estimate,
+                                      GoalNode(dest));
+            bpf.getPathFrom(src, scratch);
+        });
+
+        // Same again, with buckets instead of a heap.
+        auto bounded = boundedStepCost(stepCost, maxStepCost);
+        for (const auto &q : queries) {
+            aGoal = q.second;
+            auto bpf = makePathfinder(inlineNbrs, bounded, estimate,
+                                      GoalNode(aGoal));
+            if (pathCost(bpf.getPathFrom(q.first, scratch), stepCost) !=
+                pathCost(makeHeapPath(q.first, aGoal, neighbors, stepCost,
+                                      estimate), stepCost))
+            {
+                ++mismatches;
+            }
+        }
+        auto buckets = timeQueries_ms(queries, [&] (int src, int dest) {
+            aGoal = dest;
+            auto bpf = makePathfinder(inlineNbrs, bounded, estimate,
+                                      GoalNode(dest));
+            bpf.getPathFrom(src, scratch);
+        });
+
+        std::cout << name << ":\n"
+            << "  make_heap open list:      " << legacy << " ms/query\n"
+            << "  indexed heap, hash table: " << indexed << " ms/query\n"
+            << "  indexed heap, scratch:    " << dense << " ms/query\n"
+            << "  BasicPathfinder, scratch: " << inlined << " ms/query\n"
+            << "  BasicPathfinder, buckets: " << buckets << " ms/query\n";
+        if (mismatches > 0) {
+            std::cout << "  WARNING: " << mismatches <<
+                " queries returned paths of different cost\n";
+        }
+    }
+
+    // Visit the walkable neighbors of every hex a few times over, the way map
+    // generation and every search does.  The fixed grid is the same size,
+    // known at compile time.
+    template <typename FixedGrid>
+    void runNeighborScenario(const HexGrid &grid, const FixedGrid &fixed,
+                             const std::vector<char> &obst)
+    {
+        assert(fixed.size() == grid.size());
+
+        const int numPasses = 20;
+        auto timeSweep_ns = [&] (const std::function<int (int)> &countNbrs) {
+            auto total = 0;
+            auto startTime = Clock::now();
+            for (int i = 0; i < numPasses; ++i) {
+                for (int a = 0; a < grid.size(); ++a) {
+                    total += countNbrs(a);
+                }
+            }
+            std::chrono::duration<double, std::nano> elapsed =
+                Clock::now() - startTime;
+            return std::make_pair(elapsed.count() / numPasses / grid.size(),
+                                  total);
+        };
+
+        auto legacy = timeSweep_ns([&] (int aIndex) {
+            int count = 0;
+            for (auto n : pointNeighbors(grid, aIndex)) {
+                if (!obst[n]) ++count;
+            }
+            return count;
+        });
+        auto list = timeSweep_ns([&] (int aIndex) {
+            int count = 0;
+            for (auto n : grid.aryNeighbors(aIndex)) {
+                if (!obst[n]) ++count;
+            }
+            return count;
+        });
+        auto direct = timeSweep_ns([&] (int aIndex) {
+            int count = 0;
+            for (auto d : Dir()) {
+                auto n = grid.aryGetNeighbor(aIndex, d);
+                if (n != -1 && !obst[n]) ++count;
+            }
+            return count;
+        });
+
+        auto constant = timeSweep_ns([&] (int aIndex) {
+            int count = 0;
+            for (auto d : Dir()) {
+                auto n = fixed.aryGetNeighbor(aIndex, d);
+                if (n != -1 && !obst[n]) ++count;
+            }
+            return count;
+        });
+
+        std::cout << "Neighbors of every hex:\n"
+            << "  via Point, vector:        " << legacy.first << " ns/hex\n"
+            << "  aryNeighbors():           " << list.first << " ns/hex\n"
+            << "  aryGetNeighbor():         " << direct.first << " ns/hex\n"
+            << "  FixedHexGrid:             " << constant.first << " ns/hex\n";
+        if (list.second != legacy.second || direct.second != legacy.second ||
+            constant.second != legacy.second)
+        {
+            std::cout << "  WARNING: neighbor counts don't match\n";
+        }
+    }
+
+    void runJumpScenario(const HexGrid &grid, const std::vector<char> &obst,
+                         const std::vector<Query> &queries)
+    {
+        auto nbrs = [&] (int aIndex, NeighborList &out) {
+            for (auto d : Dir()) {
+                auto n = grid.aryGetNeighbor(aIndex, d);
+                if (n != -1 && !obst[n]) out.push_back(n);
+            }
+        };
+        auto walkable = [&] (int aIndex) { return obst[aIndex] == 0; };
+        JumpPathfinder jps(grid, walkable);
+        PathScratch scratch(grid.size());
+
+        int mismatches = 0;
+        auto aStar = [&] (int src, int dest) {
+            auto hDest = grid.hexFromAry(dest);
+            auto estimate = [&] (int aIndex) {
+                return static_cast<int>(hexDist(grid.hexFromAry(aIndex),
+                                                hDest));
+            };
+            return makePathfinder(nbrs, UnitStepCost(), estimate,
+                                  GoalNode(dest)).getPathFrom(src, scratch);
+        };
+        for (const auto &q : queries) {
+            if (aStar(q.first, q.second).size() !=
+                jps.getPath(q.first, q.second, scratch).size()) {
+                ++mismatches;
+            }
+        }
+
+        auto aStarTime = timeQueries_ms(queries, aStar);
+        auto jpsTime = timeQueries_ms(queries, [&] (int src, int dest) {
+            jps.getPath(src, dest, scratch);
+        });
+
+        std::cout << "Unit cost, jump point search:\n"
+            << "  BasicPathfinder, A*:      " << aStarTime << " ms/query\n"
+            << "  JumpPathfinder:           " << jpsTime << " ms/query\n";
+        if (mismatches > 0) {
+            std::cout << "  WARNING: " << mismatches <<
+                " queries returned paths of different cost\n";
+        }
+    }
+
+    // A unit walks toward a goal while obstacles pop up and disappear around
+    // the map.  Replan after every step, either from scratch or incrementally.
+    // Weighted A* trades path cost for fewer expansions.  Report how much of
+    // each we get at a few weights.
+    void runWeightedScenario(const HexGrid &grid,
+                             const std::vector<char> &obst,
+                             const std::function<int (int, int)> &stepCost,
+                             const std::vector<Query> &queries)
+    {
+        auto nbrs = [&] (int aIndex, NeighborList &out) {
+            for (auto d : Dir()) {
+                auto n = grid.aryGetNeighbor(aIndex, d);
+                if (n != -1 && !obst[n]) out.push_back(n);
+            }
+        };
+        auto aGoal = -1;
+        auto estimate = [&] (int aIndex) {
+            return static_cast<int>(hexDist(grid.hexFromAry(aIndex),
+                                            grid.hexFromAry(aGoal)));
+        };
+        PathScratch scratch(grid.size());
+
+        double optimalCost = 0.0;
+        for (const auto &q : queries) {
+            aGoal = q.second;
+            auto pf = makePathfinder(nbrs, stepCost, estimate,
+                                     GoalNode(aGoal));
+            optimalCost += pathCost(pf.getPathFrom(q.first, scratch),
+                                    stepCost);
+        }
+
+        std::cout << "Terrain cost, weighted A*:\n";
+        for (auto weight : {1.0, 1.5, 2.0, 3.0}) {
+            PathStats stats;
+            double totalCost = 0.0;
+            double worstBound = 1.0;
+            auto elapsed = timeQueries_ms(queries, [&] (int src, int dest) {
+                aGoal = dest;
+                auto pf = makePathfinder(nbrs, stepCost, estimate,
+                                         GoalNode(dest));
+                auto result = pf.getBoundedPath(src, scratch, weight, 0.0,
+                                                stats);
+                worstBound = std::max(worstBound, result.bound);
+                totalCost += pathCost(result.path, stepCost);
+            });
+            std::cout << "  weight " << weight << ": " << elapsed <<
+                " ms/query, " << stats.expanded / stats.searches <<
+                " nodes expanded, path cost " << totalCost / optimalCost <<
+                " of shortest, worst bound " << worstBound << '\n';
+        }
+    }
+
+    void runReplanScenario(const HexGrid &grid, std::vector<char> obst,
+                           const Query &q)
+    {
+        auto obstFixed = obst;
+        auto nbrs = [&] (int aIndex, NeighborList &out) {
+            for (auto d : Dir()) {
+                auto n = grid.aryGetNeighbor(aIndex, d);
+                if (n != -1 && !obst[n]) out.push_back(n);
+            }
+        };
+        auto hDest = grid.hexFromAry(q.second);
+        auto estimate = [&] (int aIndex) {
+            return static_cast<int>(hexDist(grid.hexFromAry(aIndex), hDest));
+        };
+        auto aStar = makePathfinder(nbrs, UnitStepCost(), estimate,
+                                    GoalNode(q.second));
+        PathScratch scratch(grid.size());
+        IncrementalPathfinder ipf(grid, [&] (int aIndex) {
+            return obst[aIndex] == 0;
+        });
+
+        std::minstd_rand gen(999);
+        std::uniform_int_distribution<int> hexDist(0, grid.size() - 1);
+        double fresh = 0.0;
+        double incremental = 0.0;
+        int mismatches = 0;
+        int numSteps = 0;
+        auto aSrc = q.first;
+        ipf.setStart(aSrc);
+        ipf.setGoal(q.second);
+
+        while (aSrc != q.second && numSteps < 200) {
+            auto startTime = Clock::now();
+            auto expected = aStar.getPathFrom(aSrc, scratch);
+            auto midTime = Clock::now();
+            auto actual = ipf.getPath();
+            auto endTime = Clock::now();
+            fresh += std::chrono::duration<double, std::milli>(
+                midTime - startTime).count();
+            incremental += std::chrono::duration<double, std::milli>(
+                endTime - midTime).count();
+            if (expected.size() != actual.size()) ++mismatches;
+            if (actual.size() < 2) break;
+
+            aSrc = actual[1];
+            ipf.setStart(aSrc);
+            ++numSteps;
+            for (int i = 0; i < 10; ++i) {
+                auto h = hexDist(gen);
+                if (h == aSrc || h == q.second) continue;
+                obst[h] = obst[h] ? obstFixed[h] : 1;
+                ipf.setWalkable(h, !obst[h]);
+            }
+        }
+
+        std::cout << "Replanning over " << numSteps << " steps:\n"
+            << "  A* from scratch:          " << fresh / numSteps <<
+            " ms/step\n"
+            << "  IncrementalPathfinder:    " << incremental / numSteps <<
+            " ms/step\n";
+        if (mismatches > 0) {
+            std::cout << "  WARNING: " << mismatches <<
+                " queries returned paths of different cost\n";
+        }
+    }
+
+    void runBatchScenario(const HexGrid &grid, const std::vector<char> &obst,
+                          int batchSize)
+    {
+        auto map = std::make_shared<JumpPathfinder>(grid, [&] (int aIndex) {
+            return obst[aIndex] == 0;
+        });
+        std::minstd_rand gen(54321);
+        std::uniform_int_distribution<int> hexDist(0, grid.size() - 1);
+        std::vector<PathService::Query> queries;
+        while (static_cast<int>(queries.size()) < batchSize) {
+            auto src = hexDist(gen);
+            auto dest = hexDist(gen);
+            if (!obst[src] && !obst[dest]) {
+                queries.emplace_back(src, dest);
+            }
+        }
+
+        std::cout << "Batch of " << batchSize << " queries, PathService:\n";
+        int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        double oneThread = 0.0;
+        for (int n = 1; n <= maxThreads; n *= 2) {
+            PathService service(map, n);
+            service.submit(queries).get();  // warm up the scratch space
+
+            auto startTime = Clock::now();
+            service.submit(queries).get();
+            std::chrono::duration<double, std::milli> elapsed =
+                Clock::now() - startTime;
+            if (n == 1) oneThread = elapsed.count();
+            std::cout << "  " << n << " thread(s): " << elapsed.count() <<
+                " ms, speedup " << oneThread / elapsed.count() << "\n";
+        }
+    }
+}
+
+int main()
+{
+    const int width = 256;
+    const int height = 256;
+    const int numQueries = 100;
+    HexGrid grid(width, height);
+    std::minstd_rand gen(12345);
+
+    // Scatter obstacles over about a quarter of the map.
+    std::bernoulli_distribution obstDist(0.25);
+    std::vector<char> obst(grid.size());
+    for (auto &o : obst) {
+        o = obstDist(gen);
+    }
+
+    // Varying step costs are what trigger updates to nodes already in the
+    // open list.
+    std::uniform_int_distribution<int> terrainDist(1, 4);
+    std::vector<int> terrainCost(grid.size());
+    for (auto &t : terrainCost) {
+        t = terrainDist(gen);
+    }
+
+    std::uniform_int_distribution<int> hexDist(0, grid.size() - 1);
+    std::vector<Query> queries;
+    while (static_cast<int>(queries.size()) < numQueries) {
+        auto src = hexDist(gen);
+        auto dest = hexDist(gen);
+        if (!obst[src] && !obst[dest]) {
+            queries.emplace_back(src, dest);
+        }
+    }
+
+    auto unitCost = [] (int, int) { return 1; };
+    auto terrain = [&] (int, int b) { return terrainCost[b]; };
+
+    runNeighborScenario(grid, FixedHexGrid<width, height>(), obst);
+    runJumpScenario(grid, obst, queries);
+    runBatchScenario(grid, obst, 10000);
+    runReplanScenario(grid, obst, queries[0]);
+    runWeightedScenario(grid, obst, terrain, queries);
+    runScenario("Unit cost, A*", grid, obst, unitCost, 1, true, queries);
+    runScenario("Unit cost, Dijkstra", grid, obst, unitCost, 1, false,
+                queries);
+    runScenario("Terrain cost, A*", grid, obst, terrain, 4, true, queries);
+    runScenario("Terrain cost, Dijkstra", grid, obst, terrain, 4, false,
+                queries);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,1146 @@
+/*
+    Copyright (C) 2012-2013 by Michael Kristofik <kristo605@gmail.com>
+    Part of the libsdl-demos project.
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    or at your option any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY.
+ 
+    See the COPYING.txt file for more details.
+*/
+#define BOOST_TEST_MODULE Pathfinder_Test
+#include <boost/test/unit_test.hpp>
+
+#include "BucketQueue.h"
+#include "ComponentLabels.h"
+#include "ContractionHierarchy.h"
+#include "FlowField.h"
+#include "HexGrid.h"
+#include "IncrementalPathfinder.h"
+#include "IndexedHeap.h"
+#include "JumpPathfinder.h"
+#include "Landmarks.h"
+#include "PathCache.h"
+#include "PathService.h"
+#include "Pathfinder.h"
+#include "RegionMap.h"
+#include "SlicedPathfinder.h"
+#include "StreamingMap.h"
+#include "algo.h"
+#include "hex_utils.h"
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Block off roughly a third of the hexes at random.
+    std::vector<char> randomObstacles(const HexGrid &grid, unsigned seed)
+    {
+        std::minstd_rand gen(seed);
+        std::bernoulli_distribution dist(0.33);
+        std::vector<char> obst(grid.size());
+        for (auto &o : obst) {
+            o = dist(gen);
+        }
+        return obst;
+    }
+
+    Pathfinder hexPathfinder(const HexGrid &grid,
+                             const std::vector<char> &obst,
+                             int aDest)
+    {
+        Pathfinder pf;
+        pf.setNeighbors([&] (int aIndex) {
+            std::vector<int> nbrs;
+            for (auto n : grid.aryNeighbors(aIndex)) {
+                if (!obst[n]) nbrs.push_back(n);
+            }
+            return nbrs;
+        });
+        pf.setGoal(aDest);
+        auto hDest = grid.hexFromAry(aDest);
+        pf.setEstimate([&grid, hDest] (int aIndex) {
+            return hexDist(grid.hexFromAry(aIndex), hDest);
+        });
+        return pf;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Heap_Decrease_Key)
+{
+    IndexedHeap<> heap(10);
+    for (int i = 0; i < 10; ++i) {
+        heap.push(i, 100 - i);
+    }
+    BOOST_CHECK_EQUAL(heap.top(), 9);
+
+    heap.decreaseKey(3, 5);
+    heap.decreaseKey(6, 1);
+    BOOST_CHECK_EQUAL(heap.pop(), 6);
+    BOOST_CHECK_EQUAL(heap.pop(), 3);
+    BOOST_CHECK(!heap.contains(3));
+    BOOST_CHECK_EQUAL(heap.topKey(), 91);
+
+    int prevKey = 0;
+    while (!heap.empty()) {
+        BOOST_CHECK_LE(prevKey, heap.topKey());
+        prevKey = heap.topKey();
+        heap.pop();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Heap_Update_Remove)
+{
+    IndexedHeap<2, std::pair<int, int>> heap(10);
+    for (int i = 0; i < 10; ++i) {
+        heap.push(i, {i % 3, i});
+    }
+    heap.update(0, {5, 0});  // move from the top to the bottom
+    heap.update(9, {-1, 9});
+    heap.remove(4);
+    heap.remove(2);
+    BOOST_CHECK(!heap.contains(4));
+
+    std::vector<int> order;
+    while (!heap.empty()) {
+        order.push_back(heap.pop());
+    }
+    std::vector<int> expected = {9, 3, 6, 1, 7, 5, 8, 0};
+    BOOST_CHECK_EQUAL_COLLECTIONS(order.begin(), order.end(),
+                                  expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(Bucket_Queue)
+{
+    BucketQueue buckets(10, 2);
+    buckets.push(0, 4);
+    buckets.push(1, 3);
+    buckets.push(2, 5);
+    buckets.decreaseKey(2, 3);
+    buckets.push(3, 40);  // forces the ring to grow
+    BOOST_CHECK_EQUAL(buckets.size(), 4);
+    BOOST_CHECK_EQUAL(buckets.topKey(), 3);
+
+    std::vector<int> keys;
+    while (!buckets.empty()) {
+        keys.push_back(buckets.topKey());
+        buckets.pop();
+    }
+    std::vector<int> expected = {3, 3, 4, 40};
+    BOOST_CHECK_EQUAL_COLLECTIONS(keys.begin(), keys.end(),
+                                  expected.begin(), expected.end());
+}
+
+// Declaring a bound on the step cost switches to a bucket queue, which should
+// find paths just as short as the heap does.
+BOOST_AUTO_TEST_CASE(Bucket_Matches_Heap)
+{
+    HexGrid grid(32, 18);
+    PathScratch scratch(grid.size());
+    std::minstd_rand gen(1);
+    std::uniform_int_distribution<int> hexDist(0, grid.size() - 1);
+    auto stepCost = [] (int, int b) { return 1 + b % 4; };
+    auto pathCost = [&] (const std::vector<int> &path) {
+        int cost = 0;
+        for (auto i = 1u; i < path.size(); ++i) {
+            cost += stepCost(path[i - 1], path[i]);
+        }
+        return cost;
+    };
+
+    for (unsigned seed = 1; seed <= 10; ++seed) {
+        auto obst = randomObstacles(grid, seed);
+        for (int i = 0; i < 20; ++i) {
+            auto aSrc = hexDist(gen);
+            auto aDest = hexDist(gen);
+            obst[aSrc] = 0;
+            obst[aDest] = 0;
+
+            auto pf = hexPathfinder(grid, obst, aDest);
+            pf.setStepCost(stepCost);
+            auto expected = pf.getPathFrom(aSrc, scratch);
+            pf.setStepCost(stepCost, 4);
+            auto actual = pf.getPathFrom(aSrc, scratch);
+            BOOST_CHECK_EQUAL(expected.size() > 0, actual.size() > 0);
+            BOOST_CHECK_EQUAL(pathCost(expected), pathCost(actual));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Straight_Line)
+{
+    HexGrid grid(16, 9);
+    std::vector<char> obst(grid.size(), 0);
+    auto aSrc = grid.aryFromHex(2, 1);
+    auto aDest = grid.aryFromHex(2, 7);
+
+    auto pf = hexPathfinder(grid, obst, aDest);
+    auto path = pf.getPathFrom(aSrc);
+    BOOST_REQUIRE_EQUAL(path.size(), 7u);
+    BOOST_CHECK_EQUAL(path.front(), aSrc);
+    BOOST_CHECK_EQUAL(path.back(), aDest);
+}
+
+BOOST_AUTO_TEST_CASE(Unreachable)
+{
+    HexGrid grid(16, 9);
+    std::vector<char> obst(grid.size(), 0);
+    for (auto n : grid.aryNeighbors(grid.aryFromHex(8, 4))) {
+        obst[n] = 1;
+    }
+
+    auto pf = hexPathfinder(grid, obst, grid.aryFromHex(8, 4));
+    PathScratch scratch(grid.size());
+    BOOST_CHECK(pf.getPathFrom(0).empty());
+    BOOST_CHECK(pf.getPathFrom(0, scratch).empty());
+}
+
+// Searching with a reusable scratch space should give the same path lengths as
+// the hash table version, no matter how many times the scratch is reused.
+BOOST_AUTO_TEST_CASE(Scratch_Matches_Hash_Table)
+{
+    HexGrid grid(32, 18);
+    PathScratch scratch(grid.size());
+    std::minstd_rand gen(1);
+    std::uniform_int_distribution<int> hexDist(0, grid.size() - 1);
+
+    for (unsigned seed = 1; seed <= 10; ++seed) {
+        auto obst = randomObstacles(grid, seed);
+        for (int i = 0; i < 20; ++i) {
+            auto aSrc = hexDist(gen);
+            auto aDest = hexDist(gen);
+            obst[aSrc] = 0;
+            obst[aDest] = 0;
+
+            auto pf = hexPathfinder(grid, obst, aDest);
+            auto expected = pf.getPathFrom(aSrc);
+            auto actual = pf.getPathFrom(aSrc, scratch);
+            BOOST_CHECK_EQUAL(expected.size(), actual.size());
+            if (!actual.empty()) {
+                BOOST_CHECK_EQUAL(actual.front(), aSrc);
+                BOOST_CHECK_EQUAL(actual.back(), aDest);
+            }
+        }
+    }
+}
+
+// A bidirectional search should find paths as short as the one-sided search,
+// with or without estimates to guide it.
+BOOST_AUTO_TEST_CASE(Bidirectional_Matches_Forward)
+{
+    HexGrid grid(32, 18);
+    PathScratch fwd(grid.size());
+    PathScratch rev(grid.size());
+    std::minstd_rand gen(2);
+    std::uniform_int_distribution<int> hexDist(0, grid.size() - 1);
+
+    for (unsigned seed = 1; seed <= 10; ++seed) {
+        auto obst = randomObstacles(grid, seed);
+        for (int i = 0; i < 20; ++i) {
+            auto aSrc = hexDist(gen);
+            auto aDest = hexDist(gen);
+            obst[aSrc] = 0;
+            obst[aDest] = 0;
+
+            auto pf = hexPathfinder(grid, obst, aDest);
+            auto expected = pf.getPathFrom(aSrc, fwd);
+
+            auto hSrc = grid.hexFromAry(aSrc);
+            pf.setReverseNeighbors([&] (int aIndex) {
+                std::vector<int> nbrs;
+                for (auto n : grid.aryNeighbors(aIndex)) {
+                    if (!obst[n]) nbrs.push_back(n);
+                }
+                return nbrs;
+            });
+            pf.setReverseEstimate([&grid, hSrc] (int aIndex) {
+                return ::hexDist(grid.hexFromAry(aIndex), hSrc);
+            });
+            auto actual = pf.getPathFrom(aSrc, fwd, rev);
+            BOOST_CHECK_EQUAL(expected.size(), actual.size());
+            BOOST_CHECK_EQUAL(pf.getPathFrom(aSrc).size(), expected.size());
+
+            // Walking the path should only take single steps.
+            for (auto j = 1u; j < actual.size(); ++j) {
+                BOOST_CHECK(contains(grid.aryNeighbors(actual[j - 1]),
+                                     actual[j]));
+            }
+
+            pf.setEstimate([] (int) { return 0; });
+            pf.setReverseEstimate([] (int) { return 0; });
+            BOOST_CHECK_EQUAL(pf.getPathFrom(aSrc, fwd, rev).size(),
+                              expected.size());
+        }
+    }
+}
+
+// One-way edges: node n leads to n+1 cheaply and to n+2 at a higher cost.
+BOOST_AUTO_TEST_CASE(Bidirectional_Directed)
+{
+    auto nbrs = [] (int n, NeighborList &out) {
+        if (n + 1 < 20) out.push_back(n + 1);
+        if (n + 2 < 20) out.push_back(n + 2);
+    };
+    auto revNbrs = [] (int n, NeighborList &out) {
+        if (n - 1 >= 0) out.push_back(n - 1);
+        if (n - 2 >= 0) out.push_back(n - 2);
+    };
+    auto cost = [] (int a, int b) { return b - a == 1 ? 2 : 3; };
+
+    auto pf = makeBidirectionalPathfinder(nbrs, revNbrs, cost,
+                                          ZeroEstimate(), ZeroEstimate());
+    PathScratch fwd(20);
+    PathScratch rev(20);
+    auto path = pf.getPath(0, 19, fwd, rev);
+    BOOST_REQUIRE(!path.empty());
+    BOOST_CHECK_EQUAL(path.front(), 0);
+    BOOST_CHECK_EQUAL(path.back(), 19);
+    BOOST_CHECK_EQUAL(path.size(), 11u);  // nine jumps of 2, one step of 1
+    BOOST_CHECK(pf.getPath(19, 0, fwd, rev).empty());
+}
+
+// Neighbor lists longer than a hex grid's should still work.
+BOOST_AUTO_TEST_CASE(Many_Neighbors)
+{
+    // Node 0 connects to nodes 1-10, each of which connects to node 11.  Only
+    // the last one is cheap to leave.
+    auto nbrs = [] (int n, NeighborList &out) {
+        if (n == 0) {
+            for (int i = 1; i <= 10; ++i) out.push_back(i);
+        }
+        else if (n <= 10) {
+            out.push_back(11);
+        }
+    };
+    auto cost = [] (int a, int b) { return (b == 11 && a != 10) ? 5 : 1; };
+
+    auto pf = makePathfinder(nbrs, cost, ZeroEstimate(), GoalNode(11));
+    PathScratch scratch(12);
+    std::vector<int> expected = {0, 10, 11};
+    auto path = pf.getPathFrom(0, scratch);
+    BOOST_CHECK_EQUAL_COLLECTIONS(path.begin(), path.end(),
+                                  expected.begin(), expected.end());
+    path = pf.getPathFrom(0);
+    BOOST_CHECK_EQUAL_COLLECTIONS(path.begin(), path.end(),
+                                  expected.begin(), expected.end());
+}
+
+// Weighted paths may be longer than the shortest path, but never by more than
+// the bound.  Given enough time, the anytime search finds the shortest path.
+BOOST_AUTO_TEST_CASE(Weighted_Anytime)
+{
+    HexGrid grid(32, 18);
+    PathScratch scratch(grid.size());
+    std::minstd_rand gen(1);
+    std::uniform_int_distribution<int> hexDist(0, grid.size() - 1);
+
+    for (unsigned seed = 1; seed <= 10; ++seed) {
+        auto obst = randomObstacles(grid, seed);
+        for (int i = 0; i < 20; ++i) {
+            auto aSrc = hexDist(gen);
+            auto aDest = hexDist(gen);
+            obst[aSrc] = 0;
+            obst[aDest] = 0;
+
+            auto pf = hexPathfinder(grid, obst, aDest);
+            auto shortest = pf.getPathFrom(aSrc, scratch);
+            pf.setWeight(2.0);
+            auto weighted = pf.getBoundedPath(aSrc, scratch, 0.0);
+            auto anytime = pf.getBoundedPath(aSrc, scratch, 1000.0);
+            BOOST_REQUIRE_EQUAL(shortest.empty(), weighted.path.empty());
+            if (shortest.empty()) continue;
+
+            BOOST_CHECK_LE(weighted.bound, 2.0);
+            BOOST_CHECK_LE(weighted.path.size() - 1,
+                           weighted.bound * (shortest.size() - 1));
+            BOOST_CHECK_LE(pf.getPathFrom(aSrc).size() - 1,
+                           2 * (shortest.size() - 1));
+            BOOST_CHECK_EQUAL(anytime.bound, 1.0);
+            BOOST_CHECK_EQUAL(anytime.path.size(), shortest.size());
+            BOOST_CHECK_EQUAL(anytime.path.front(), aSrc);
+            BOOST_CHECK_EQUAL(anytime.path.back(), aDest);
+        }
+    }
+}
+
+// Spreading a search over many small slices should find the same path as
+// doing it all at once.
+BOOST_AUTO_TEST_CASE(Time_Sliced)
+{
+    HexGrid grid(32, 18);
+    PathScratch scratch(grid.size());
+    std::minstd_rand gen(1);
+    std::uniform_int_distribution<int> hexDist(0, grid.size() - 1);
+    auto obst = randomObstacles(grid, 1);
+    auto nbrs = [&] (int aIndex, NeighborList &out) {
+        for (auto n : grid.aryNeighbors(aIndex)) {
+            if (!obst[n]) out.push_back(n);
+        }
+    };
+
+    for (int i = 0; i < 50; ++i) {
+        auto aSrc = hexDist(gen);
+        auto aDest = hexDist(gen);
+        obst[aSrc] = 0;
+        obst[aDest] = 0;
+
+        auto pf = makePathfinder(nbrs, UnitStepCost(), ZeroEstimate(),
+                                 GoalNode(aDest));
+        PathStats expectedStats;
+        auto expected = pf.getPathFrom(aSrc, scratch, expectedStats);
+
+        auto sliced = makeSlicedPathfinder(nbrs, UnitStepCost(),
+                                           ZeroEstimate(), GoalNode(aDest),
+                                           aSrc, scratch);
+        PathStats stats;
+        int numSlices = 0;
+        for (;;) {
+            SliceBudget budget(10, -1.0);
+            ++numSlices;
+            if (sliced.resume(budget, stats)) break;
+            BOOST_CHECK_EQUAL(budget.spent(), 10);
+        }
+        BOOST_CHECK(sliced.done());
+        BOOST_CHECK_EQUAL(sliced.getPath().size(), expected.size());
+        if (aSrc != aDest) {
+            BOOST_CHECK_EQUAL(stats.searches, 1);
+            BOOST_CHECK_EQUAL(stats.expanded, expectedStats.expanded);
+            BOOST_CHECK_EQUAL(stats.pushes, expectedStats.pushes);
+        }
+        if (expected.size() > 20) {
+            BOOST_CHECK_GT(numSlices, 1);
+        }
+    }
+}
+
+// Jump point search should find paths as short as A*, with every hex filled
+// in, and respect group boundaries.
+BOOST_AUTO_TEST_CASE(Jump_Point_Search)
+{
+    HexGrid grid(32, 18);
+    PathScratch fwd(grid.size());
+    PathScratch jps(grid.size());
+    std::minstd_rand gen(3);
+    std::uniform_int_distribution<int> hexDist(0, grid.size() - 1);
+
+    // Left and right halves of the map.
+    auto half = [&grid] (int aIndex) {
+        return grid.hexFromAry(aIndex).first < grid.width() / 2;
+    };
+
+    for (unsigned seed = 1; seed <= 10; ++seed) {
+        auto obst = randomObstacles(grid, seed);
+        auto walkable = [&obst] (int aIndex) { return obst[aIndex] == 0; };
+        for (int i = 0; i < 20; ++i) {
+            auto aSrc = hexDist(gen);
+            auto aDest = hexDist(gen);
+            obst[aSrc] = 0;
+            obst[aDest] = 0;
+
+            JumpPathfinder jpf(grid, walkable);
+            auto expected = hexPathfinder(grid, obst, aDest).getPathFrom(aSrc,
+                                                                         fwd);
+            auto actual = jpf.getPath(aSrc, aDest, jps);
+            BOOST_CHECK_EQUAL(expected.size(), actual.size());
+            if (!actual.empty()) {
+                BOOST_CHECK_EQUAL(actual.front(), aSrc);
+                BOOST_CHECK_EQUAL(actual.back(), aDest);
+            }
+            for (auto j = 1u; j < actual.size(); ++j) {
+                BOOST_CHECK(contains(grid.aryNeighbors(actual[j - 1]),
+                                     actual[j]));
+                BOOST_CHECK(!obst[actual[j]]);
+            }
+
+            JumpPathfinder halves(grid, walkable, half);
+            auto split = halves.getPath(aSrc, aDest, jps);
+            if (half(aSrc) != half(aDest)) {
+                BOOST_CHECK(split.empty());
+            }
+            for (auto h : split) {
+                BOOST_CHECK_EQUAL(half(h), half(aSrc));
+            }
+        }
+    }
+
+    // Opening and blocking hexes one at a time gives the same paths as
+    // building the tables from scratch.
+    auto edits = randomObstacles(grid, 11);
+    auto editWalkable = [&edits] (int aIndex) { return edits[aIndex] == 0; };
+    JumpPathfinder edited(grid, editWalkable, half);
+    for (int i = 0; i < 200; ++i) {
+        auto aIndex = hexDist(gen);
+        edits[aIndex] = !edits[aIndex];
+        if (edits[aIndex]) {
+            edited.remove(aIndex);
+        }
+        else {
+            edited.add(aIndex);
+        }
+
+        auto aSrc = hexDist(gen);
+        auto aDest = hexDist(gen);
+        JumpPathfinder rebuilt(grid, editWalkable, half);
+        BOOST_CHECK(edited.getPath(aSrc, aDest, jps) ==
+                    rebuilt.getPath(aSrc, aDest, fwd));
+    }
+
+    // Straight lines longer than a table entry can hold.  The obstacle makes
+    // a jump point too far away to store too.
+    HexGrid tall(3, 140000);
+    std::vector<char> obst(tall.size(), 0);
+    obst[tall.aryFromHex(1, 100000)] = 1;
+    JumpPathfinder longLines(tall, [&obst] (int aIndex) {
+        return obst[aIndex] == 0;
+    });
+    PathScratch tallScratch(tall.size());
+    for (auto hDest : {Point{0, 139999}, Point{1, 139999}, Point{2, 100001}}) {
+        auto aSrc = tall.aryFromHex(1, 0);
+        auto aDest = tall.aryFromHex(hDest);
+        auto expected = hexPathfinder(tall, obst, aDest).getPathFrom(aSrc,
+            tallScratch);
+        auto actual = longLines.getPath(aSrc, aDest, tallScratch);
+        BOOST_CHECK_EQUAL(actual.size(), expected.size());
+    }
+}
+
+// Landmark estimates never overshoot the real distance, so A* finds paths just
+// as short, with less work than straight-line distance.
+BOOST_AUTO_TEST_CASE(Landmark_Estimate)
+{
+    HexGrid grid(32, 18);
+    PathScratch scratch(grid.size());
+    std::minstd_rand gen(5);
+    std::uniform_int_distribution<int> randomHex(0, grid.size() - 1);
+
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        auto obst = randomObstacles(grid, seed);
+        auto walkable = [&obst] (int aIndex) { return obst[aIndex] == 0; };
+        Landmarks lm(grid, walkable, 6);
+        BOOST_CHECK_EQUAL(lm.size(), 6);
+        for (int i = 0; i < lm.size(); ++i) {
+            BOOST_CHECK(walkable(lm.landmark(i)));
+            BOOST_CHECK_EQUAL(lm.distance(i, lm.landmark(i)), 0);
+        }
+
+        PathStats hexStats;
+        PathStats altStats;
+        for (int i = 0; i < 50; ++i) {
+            auto aSrc = randomHex(gen);
+            auto aDest = randomHex(gen);
+            if (obst[aSrc] || obst[aDest]) continue;
+
+            auto pf = hexPathfinder(grid, obst, aDest);
+            auto expected = pf.getPathFrom(aSrc, scratch, hexStats);
+            pf.setEstimate(lm.estimateTo(aDest));
+            auto actual = pf.getPathFrom(aSrc, scratch, altStats);
+            BOOST_CHECK_EQUAL(expected.size(), actual.size());
+
+            auto est = lm.estimate(aSrc, aDest);
+            BOOST_CHECK_GE(est, hexDist(grid.hexFromAry(aSrc),
+                                        grid.hexFromAry(aDest)));
+            if (!expected.empty()) {
+                BOOST_CHECK_LE(est, static_cast<int>(expected.size()) - 1);
+            }
+        }
+        BOOST_CHECK_LE(altStats.expanded, hexStats.expanded);
+
+        // Still never overshoots as hexes open up and get blocked.
+        for (int i = 0; i < 100; ++i) {
+            auto aIndex = randomHex(gen);
+            obst[aIndex] = !obst[aIndex];
+            if (obst[aIndex]) {
+                lm.remove(aIndex);
+            }
+            else {
+                lm.add(aIndex);
+            }
+
+            auto aSrc = randomHex(gen);
+            auto aDest = randomHex(gen);
+            if (obst[aSrc] || obst[aDest]) continue;
+            auto path = hexPathfinder(grid, obst, aDest).getPathFrom(aSrc,
+                                                                     scratch);
+            if (!path.empty()) {
+                BOOST_CHECK_LE(lm.estimate(aSrc, aDest),
+                               static_cast<int>(path.size()) - 1);
+            }
+        }
+    }
+
+    // Distances too long for 16 bits don't throw off the estimate.  With no
+    // obstacles, it's exactly the straight-line distance.
+    HexGrid tall(2, 70000);
+    Landmarks far(tall, [] (int) { return true; }, 2);
+    BOOST_CHECK_EQUAL(far.distance(0, far.landmark(1)), -1);
+    for (int hy = 0; hy < tall.height(); hy += 997) {
+        auto aFrom = tall.aryFromHex(0, hy);
+        auto aTo = tall.aryFromHex(1, tall.height() - 1 - hy);
+        BOOST_CHECK_EQUAL(far.estimate(aFrom, aTo),
+                          hexDist(tall.hexFromAry(aFrom),
+                                  tall.hexFromAry(aTo)));
+    }
+}
+
+// Labels kept up to date one hex at a time should agree with labelling the
+// whole map from scratch.
+BOOST_AUTO_TEST_CASE(Component_Labels)
+{
+    HexGrid grid(32, 18);
+    std::minstd_rand gen(11);
+    std::uniform_int_distribution<int> randomHex(0, grid.size() - 1);
+
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        auto obst = randomObstacles(grid, seed);
+        auto walkable = [&obst] (int aIndex) { return obst[aIndex] == 0; };
+        ComponentLabels labels(grid, walkable);
+
+        for (int i = 0; i < 200; ++i) {
+            auto aIndex = randomHex(gen);
+            obst[aIndex] = !obst[aIndex];
+            if (obst[aIndex]) {
+                labels.remove(aIndex);
+            }
+            else {
+                labels.add(aIndex);
+            }
+            BOOST_CHECK_EQUAL(labels.label(aIndex) == -1, obst[aIndex] != 0);
+
+            ComponentLabels fresh(grid, walkable);
+            for (int j = 0; j < 20; ++j) {
+                auto a = randomHex(gen);
+                auto b = randomHex(gen);
+                BOOST_CHECK_EQUAL(labels.connected(a, b),
+                                  fresh.connected(a, b));
+            }
+        }
+    }
+}
+
+// Indexed paths should be just as short as A*, and fully filled in.
+BOOST_AUTO_TEST_CASE(Contraction_Hierarchy)
+{
+    HexGrid grid(32, 18);
+    PathScratch scratch(grid.size());
+    PathScratch revScratch(grid.size());
+    std::minstd_rand gen(13);
+    std::uniform_int_distribution<int> randomHex(0, grid.size() - 1);
+
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        auto obst = randomObstacles(grid, seed);
+        auto walkable = [&obst] (int aIndex) { return obst[aIndex] == 0; };
+        ContractionHierarchy ch(grid, walkable);
+        BOOST_CHECK(ch.memoryUsed() > 0);
+
+        for (int i = 0; i < 50; ++i) {
+            auto aSrc = randomHex(gen);
+            auto aDest = randomHex(gen);
+            if (obst[aSrc] || obst[aDest]) continue;
+
+            auto pf = hexPathfinder(grid, obst, aDest);
+            auto expected = pf.getPathFrom(aSrc, scratch);
+            auto actual = ch.getPath(aSrc, aDest, scratch, revScratch);
+            BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+            if (actual.empty()) continue;
+
+            BOOST_CHECK_EQUAL(actual.front(), aSrc);
+            BOOST_CHECK_EQUAL(actual.back(), aDest);
+            for (auto j = 1u; j < actual.size(); ++j) {
+                BOOST_CHECK(contains(grid.aryNeighbors(actual[j - 1]),
+                                     actual[j]));
+                BOOST_CHECK(!obst[actual[j]]);
+            }
+        }
+    }
+}
+
+// Every hex's distance in a flow field should match the length of the path
+// A* finds to the nearest goal.
+BOOST_AUTO_TEST_CASE(Flow_Field)
+{
+    HexGrid grid(32, 18);
+    PathScratch scratch(grid.size());
+    FlowField field(grid);
+    std::minstd_rand gen(4);
+    std::uniform_int_distribution<int> hexDist(0, grid.size() - 1);
+
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        auto obst = randomObstacles(grid, seed);
+        auto goal1 = hexDist(gen);
+        auto goal2 = hexDist(gen);
+        std::vector<int> sources(20);
+        for (auto &aSrc : sources) {
+            aSrc = hexDist(gen);
+            obst[aSrc] = 0;
+        }
+        obst[goal1] = 0;
+        obst[goal2] = 0;
+        field.build({goal1, goal2},
+                    [&obst] (int aIndex) { return obst[aIndex] == 0; });
+
+        for (auto aSrc : sources) {
+            auto path1 = hexPathfinder(grid, obst, goal1).getPathFrom(aSrc,
+                                                                     scratch);
+            auto path2 = hexPathfinder(grid, obst, goal2).getPathFrom(aSrc,
+                                                                     scratch);
+            if (path1.empty() && path2.empty()) {
+                BOOST_CHECK(!field.reachable(aSrc));
+                BOOST_CHECK(field.getPathFrom(aSrc).empty());
+                continue;
+            }
+
+            auto best = (path2.empty() ||
+                         (!path1.empty() && path1.size() < path2.size())) ?
+                path1.size() : path2.size();
+            BOOST_CHECK_EQUAL(field.distance(aSrc), static_cast<int>(best) - 1);
+            auto path = field.getPathFrom(aSrc);
+            BOOST_CHECK_EQUAL(path.size(), best);
+            BOOST_CHECK(path.back() == goal1 || path.back() == goal2);
+            BOOST_CHECK_EQUAL(field.nextHex(path.back()), -1);
+        }
+    }
+}
+
+// Batches should come back in order with the same paths a single thread finds.
+BOOST_AUTO_TEST_CASE(Path_Service)
+{
+    HexGrid grid(32, 18);
+    auto obst = randomObstacles(grid, 5);
+    auto map = std::make_shared<JumpPathfinder>(grid, [&obst] (int aIndex) {
+        return obst[aIndex] == 0;
+    });
+    PathScratch scratch(grid.size());
+    std::minstd_rand gen(5);
+    std::uniform_int_distribution<int> hexDist(0, grid.size() - 1);
+
+    std::vector<PathService::Query> queries;
+    PathService::Results expected;
+    for (int i = 0; i < 500; ++i) {
+        auto aSrc = hexDist(gen);
+        auto aDest = hexDist(gen);
+        queries.emplace_back(aSrc, aDest);
+        expected.push_back(map->getPath(aSrc, aDest, scratch));
+    }
+
+    PathService service(map, 4);
+    BOOST_CHECK_EQUAL(service.numThreads(), 4);
+    auto results = service.submit(queries).get();
+    BOOST_CHECK(results == expected);
+
+    std::promise<PathService::Results> fromCallback;
+    service.submit(queries, [&] (PathService::Results r) {
+        fromCallback.set_value(std::move(r));
+    });
+    BOOST_CHECK(fromCallback.get_future().get() == expected);
+    BOOST_CHECK(service.submit({}).get().empty());
+}
+
+// After obstacles change and the start moves, the repaired path should be as
+// short as a fresh search.
+BOOST_AUTO_TEST_CASE(Incremental_Replanning)
+{
+    HexGrid grid(32, 18);
+    PathScratch scratch(grid.size());
+    std::minstd_rand gen(6);
+    std::uniform_int_distribution<int> hexDist(0, grid.size() - 1);
+
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        auto obst = randomObstacles(grid, seed);
+        auto aSrc = hexDist(gen);
+        auto aDest = hexDist(gen);
+        obst[aSrc] = 0;
+        obst[aDest] = 0;
+
+        IncrementalPathfinder ipf(grid, [&obst] (int aIndex) {
+            return obst[aIndex] == 0;
+        });
+        ipf.setStart(aSrc);
+        ipf.setGoal(aDest);
+
+        for (int round = 0; round < 10; ++round) {
+            auto expected = hexPathfinder(grid, obst, aDest).getPathFrom(aSrc,
+                                                                         scratch);
+            auto actual = ipf.getPath();
+            BOOST_CHECK_EQUAL(expected.size(), actual.size());
+            for (auto j = 1u; j < actual.size(); ++j) {
+                BOOST_CHECK(contains(grid.aryNeighbors(actual[j - 1]),
+                                     actual[j]));
+                BOOST_CHECK(!obst[actual[j]]);
+            }
+
+            // Take a couple of steps, then flip some hexes.
+            if (actual.size() > 2) {
+                aSrc = actual[2];
+                ipf.setStart(aSrc);
+            }
+            for (int i = 0; i < 15; ++i) {
+                auto h = hexDist(gen);
+                if (h == aSrc || h == aDest) continue;
+                obst[h] = !obst[h];
+                ipf.setWalkable(h, !obst[h]);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Path_Cache)
+{
+    PathCache cache(2);
+    cache.insert(1, 2, 0, {1, 2});
+    cache.insert(3, 4, 0, {3, 4});
+    BOOST_REQUIRE(cache.find(1, 2, 0));  // now the most recently used
+    BOOST_CHECK_EQUAL(cache.find(1, 2, 0)->back(), 2);
+
+    // Full, so the least recently used path goes.
+    cache.insert(5, 6, 0, {5, 6});
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+    BOOST_CHECK(!cache.find(3, 4, 0));
+    BOOST_CHECK(cache.find(5, 6, 0));
+    BOOST_CHECK(!cache.find(2, 1, 0));  // direction matters
+
+    // New map version, nothing is valid anymore.
+    BOOST_CHECK(!cache.find(1, 2, 1));
+    BOOST_CHECK_EQUAL(cache.size(), 0);
+
+    BOOST_CHECK_EQUAL(cache.hits(), 3);
+    BOOST_CHECK_EQUAL(cache.misses(), 3);
+}
+
+// Stats should add up the same work no matter which search collects them.
+BOOST_AUTO_TEST_CASE(Path_Stats)
+{
+    HexGrid grid(32, 18);
+    auto obst = randomObstacles(grid, 7);
+    auto aSrc = grid.aryFromHex(0, 0);
+    auto aDest = grid.aryFromHex(31, 17);
+    obst[aSrc] = 0;
+    obst[aDest] = 0;
+    PathScratch scratch(grid.size());
+    auto pf = hexPathfinder(grid, obst, aDest);
+
+    PathStats stats;
+    auto path = pf.getPathFrom(aSrc, scratch, stats);
+    BOOST_CHECK(path == pf.getPathFrom(aSrc, scratch));
+    BOOST_CHECK_EQUAL(stats.searches, 1);
+    BOOST_CHECK_EQUAL(stats.pops, stats.expanded + (path.empty() ? 0 : 1));
+    BOOST_CHECK(stats.generated >= stats.pushes - 1);
+    BOOST_CHECK(stats.peakOpen <= stats.pushes);
+    BOOST_CHECK(stats.elapsed_ms >= 0.0);
+
+    PathStats total;
+    total += stats;
+    total += stats;
+    BOOST_CHECK_EQUAL(total.searches, 2);
+    BOOST_CHECK_EQUAL(total.expanded, 2 * stats.expanded);
+    BOOST_CHECK_EQUAL(total.peakOpen, stats.peakOpen);
+}
+
+// Generated maps have no islands, and the time-sliced searches find the same
+// paths as the regular ones.
+BOOST_AUTO_TEST_CASE(Region_Map)
+{
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        randomGenerator().seed(seed);
+        RegionMap map(32, 18);
+        const auto &grid = map.grid();
+        BOOST_CHECK_GT(map.numPortals(), 0);
+        std::minstd_rand gen(seed);
+        std::uniform_int_distribution<int> randomHex(0, grid.size() - 1);
+
+        for (int i = 0; i < 50; ++i) {
+            auto aSrc = randomHex(gen);
+            auto aDest = randomHex(gen);
+            if (!map.walkable(aSrc) || !map.walkable(aDest)) {
+                BOOST_CHECK(map.findPath(aSrc, aDest).empty());
+                continue;
+            }
+
+            // Find the time-sliced path first so it doesn't come from the
+            // cache.
+            if (!map.requestPath(aSrc, aDest)) {
+                BOOST_CHECK(map.pathPending());
+                for (;;) {
+                    SliceBudget budget(10, -1.0);
+                    if (map.updatePath(budget)) break;
+                }
+            }
+            BOOST_CHECK(!map.pathPending());
+            auto sliced = map.getRequestedPath();
+
+            auto path = map.findPath(aSrc, aDest);
+            BOOST_REQUIRE(!path.empty());
+            BOOST_CHECK_EQUAL(path.front(), aSrc);
+            BOOST_CHECK_EQUAL(path.back(), aDest);
+            for (auto j = 1u; j < path.size(); ++j) {
+                BOOST_CHECK(map.walkable(path[j]));
+                BOOST_CHECK_EQUAL(hexDist(grid.hexFromAry(path[j - 1]),
+                                          grid.hexFromAry(path[j])), 1);
+            }
+            BOOST_CHECK(sliced.front() == aSrc && sliced.back() == aDest);
+
+            // The regions along the path must be connected.
+            auto route = map.getRegionRoute(map.region(aSrc),
+                                            map.region(aDest));
+            BOOST_REQUIRE(!route.empty());
+            BOOST_CHECK_EQUAL(route.back(), map.region(aDest));
+            for (auto j = 1u; j < route.size(); ++j) {
+                BOOST_CHECK(contains(map.regionGraph()[route[j - 1]],
+                                     route[j]));
+            }
+        }
+    }
+}
+
+// Corridor mode should find a path whenever portal mode does.
+BOOST_AUTO_TEST_CASE(Region_Map_Corridor)
+{
+    randomGenerator().seed(3);
+    RegionMap map(32, 18);
+    const auto &grid = map.grid();
+    std::minstd_rand gen(3);
+    std::uniform_int_distribution<int> randomHex(0, grid.size() - 1);
+
+    for (int i = 0; i < 50; ++i) {
+        auto aSrc = randomHex(gen);
+        auto aDest = randomHex(gen);
+        if (!map.walkable(aSrc) || !map.walkable(aDest)) continue;
+
+        map.setPathMode(RegionMap::PathMode::Portals);
+        auto portalPath = map.findPath(aSrc, aDest);
+        map.setPathMode(RegionMap::PathMode::Corridor);
+        auto path = map.findPath(aSrc, aDest);
+        BOOST_CHECK_EQUAL(path.empty(), portalPath.empty());
+        if (path.empty()) continue;
+
+        BOOST_CHECK_EQUAL(path.front(), aSrc);
+        BOOST_CHECK_EQUAL(path.back(), aDest);
+        for (auto j = 1u; j < path.size(); ++j) {
+            BOOST_CHECK(map.walkable(path[j]));
+            BOOST_CHECK_EQUAL(hexDist(grid.hexFromAry(path[j - 1]),
+                                      grid.hexFromAry(path[j])), 1);
+        }
+    }
+}
+
+// Walling off a hex should stop paths to it without any searching.
+BOOST_AUTO_TEST_CASE(Region_Map_Obstacles)
+{
+    randomGenerator().seed(2);
+    RegionMap map(32, 18);
+    const auto &grid = map.grid();
+    auto aSrc = -1;
+    auto aDest = -1;
+    for (int i = 0; i < grid.size(); ++i) {
+        if (!map.walkable(i)) continue;
+        if (aSrc == -1) {
+            aSrc = i;
+        }
+        else if (map.region(i) != map.region(aSrc) &&
+                 grid.aryNeighbors(i).size() == 6) {
+            aDest = i;
+        }
+    }
+    BOOST_REQUIRE(aDest != -1);
+    BOOST_REQUIRE(!map.findPath(aSrc, aDest).empty());
+
+    auto nbrs = grid.aryNeighbors(aDest);
+    for (auto n : nbrs) {
+        map.setObstacle(n, true);
+    }
+    map.setCollectStats(true);
+    BOOST_CHECK(map.findPath(aSrc, aDest).empty());
+    BOOST_CHECK(map.getPathStats().empty());
+    BOOST_CHECK(map.requestPath(aSrc, aDest));
+    BOOST_CHECK(map.getRequestedPath().empty());
+
+    map.setObstacle(nbrs[0], false);
+    auto path = map.findPath(aSrc, aDest);
+    BOOST_REQUIRE(!path.empty());
+    BOOST_CHECK_EQUAL(path[path.size() - 2], nbrs[0]);
+
+    // Sliced searches count their work too.
+    map.setObstacle(nbrs[1], false);
+    BOOST_REQUIRE(!map.requestPath(aSrc, aDest));
+    SliceBudget budget(-1, -1.0);
+    BOOST_REQUIRE(map.updatePath(budget));
+    BOOST_CHECK(!map.getRequestedPath().empty());
+    BOOST_REQUIRE(!map.getPathStats().empty());
+    BOOST_CHECK_GT(map.getPathStats()[0].expanded, 0);
+}
+
+// Blocking hexes can cut a region in two.  A path should still turn up
+// whenever there is one, by every way of asking for it.
+BOOST_AUTO_TEST_CASE(Region_Map_Edits)
+{
+    std::minstd_rand gen(6);
+    for (unsigned seed = 1; seed <= 4; ++seed) {
+        randomGenerator().seed(seed);
+        RegionMap map(48, 30);
+        const auto &grid = map.grid();
+        std::uniform_int_distribution<int> randomHex(0, grid.size() - 1);
+        std::vector<int> reached;
+        std::vector<char> seen;
+        auto checkPath = [&] (const std::vector<int> &path, int aSrc,
+                              int aDest) {
+            BOOST_REQUIRE_EQUAL(path.empty(), seen[aDest] == 0);
+            if (path.empty()) return;
+            BOOST_CHECK_EQUAL(path.front(), aSrc);
+            BOOST_CHECK_EQUAL(path.back(), aDest);
+            for (auto i = 1u; i < path.size(); ++i) {
+                BOOST_CHECK(map.walkable(path[i]));
+                BOOST_CHECK(contains(grid.aryNeighbors(path[i - 1]),
+                                     path[i]));
+            }
+        };
+
+        for (int round = 0; round < 8; ++round) {
+            for (int i = 0; i < 15; ++i) {
+                auto aIndex = randomHex(gen);
+                map.setObstacle(aIndex, map.walkable(aIndex));
+            }
+
+            for (int q = 0; q < 20; ++q) {
+                auto aSrc = randomHex(gen);
+                auto aDest = randomHex(gen);
+                if (!map.walkable(aSrc) || !map.walkable(aDest)) continue;
+
+                // Everywhere we can walk to from the source.
+                seen.assign(grid.size(), 0);
+                seen[aSrc] = 1;
+                reached.assign(1, aSrc);
+                for (auto j = 0u; j < reached.size(); ++j) {
+                    for (auto n : grid.aryNeighbors(reached[j])) {
+                        if (!seen[n] && map.walkable(n)) {
+                            seen[n] = 1;
+                            reached.push_back(n);
+                        }
+                    }
+                }
+
+                map.setPathMode(RegionMap::PathMode::Portals);
+                checkPath(map.findPath(aSrc, aDest), aSrc, aDest);
+                if (!map.requestPath(aSrc, aDest)) {
+                    SliceBudget budget(-1, -1.0);
+                    BOOST_REQUIRE(map.updatePath(budget));
+                }
+                checkPath(map.getRequestedPath(), aSrc, aDest);
+
+                map.setPathMode(RegionMap::PathMode::Corridor);
+                checkPath(map.findPath(aSrc, aDest), aSrc, aDest);
+                if (!map.requestPath(aSrc, aDest)) {
+                    SliceBudget budget(-1, -1.0);
+                    BOOST_REQUIRE(map.updatePath(budget));
+                }
+                checkPath(map.getRequestedPath(), aSrc, aDest);
+            }
+        }
+    }
+}
+
+// Opening and blocking hexes along the borders links and unlinks regions.
+// Routes should always cross as few borders as you'd have to walk across.
+BOOST_AUTO_TEST_CASE(Region_Map_Routes)
+{
+    randomGenerator().seed(3);
+    RegionMap map(40, 30, 14);
+    const auto &grid = map.grid();
+    auto numRegions = map.numRegions();
+    std::minstd_rand gen(9);
+
+    std::vector<int> border;
+    for (int i = 0; i < grid.size(); ++i) {
+        for (auto n : grid.aryNeighbors(i)) {
+            if (map.region(n) != map.region(i)) {
+                border.push_back(i);
+                break;
+            }
+        }
+    }
+    std::uniform_int_distribution<int> randomBorder(0, border.size() - 1);
+    std::bernoulli_distribution block(0.7);
+
+    std::vector<char> linked;
+    std::vector<int> hops;
+    std::vector<int> queue;
+    for (int i = 0; i < 400; ++i) {
+        auto aIndex = border[randomBorder(gen)];
+        map.setObstacle(aIndex, map.walkable(aIndex) == block(gen));
+
+        // Regions you can walk between directly.
+        linked.assign(numRegions * numRegions, 0);
+        for (int a = 0; a < grid.size(); ++a) {
+            if (!map.walkable(a)) continue;
+            for (auto n : grid.aryNeighbors(a)) {
+                if (map.walkable(n) && map.region(n) != map.region(a)) {
+                    linked[map.region(a) * numRegions + map.region(n)] = 1;
+                }
+            }
+        }
+
+        for (int rDest = 0; rDest < numRegions; ++rDest) {
+            hops.assign(numRegions, -1);
+            hops[rDest] = 0;
+            queue.assign(1, rDest);
+            for (auto j = 0u; j < queue.size(); ++j) {
+                for (int r = 0; r < numRegions; ++r) {
+                    if (linked[queue[j] * numRegions + r] && hops[r] == -1) {
+                        hops[r] = hops[queue[j]] + 1;
+                        queue.push_back(r);
+                    }
+                }
+            }
+
+            for (int rSrc = 0; rSrc < numRegions; ++rSrc) {
+                auto route = map.getRegionRoute(rSrc, rDest);
+                BOOST_CHECK_EQUAL(static_cast<int>(route.size()) - 1,
+                                  hops[rSrc]);
+                for (auto j = 1u; j < route.size(); ++j) {
+                    BOOST_CHECK(linked[route[j - 1] * numRegions + route[j]]);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Streaming_Map)
+{
+    // Chunks come out the same whatever order they're built in, including
+    // after being evicted and built again.
+    StreamingMap map1(7, 4);
+    StreamingMap map2(7, 64);
+    map2.setView({-100, -100}, {100, 100});
+    for (int i = 0; i < 200; ++i) {
+        Point hex = {i * 37 % 400 - 200, i * 53 % 300 - 150};
+        BOOST_CHECK_EQUAL(map1.region(hex), map2.region(hex));
+        BOOST_CHECK_EQUAL(map1.terrain(hex), map2.terrain(hex));
+        BOOST_CHECK_EQUAL(map1.walkable(hex), map2.walkable(hex));
+    }
+    BOOST_CHECK_LE(map1.numChunks(), 4);
+
+    // Regions carry on across chunk borders, and the hexes where two regions
+    // meet are always walkable.
+    int crossings = 0;
+    for (int hy = -70; hy < 70; ++hy) {
+        for (int hx = -70; hx < 70; ++hx) {
+            Point hex = {hx, hy};
+            for (auto d : Dir()) {
+                auto n = adjacent(hex, d);
+                if (map2.region(n) != map2.region(hex)) {
+                    BOOST_CHECK(map2.walkable(hex));
+                    if (hx % StreamingMap::chunkSize == 0) ++crossings;
+                }
+            }
+        }
+    }
+    BOOST_CHECK_GT(crossings, 0);
+
+    // Memory stays bounded however far the view goes.
+    StreamingMap map3(7, 32);
+    for (int x = 0; x < 20000; x += 10) {
+        map3.setView({x, 0}, {x + 35, 14});
+        BOOST_REQUIRE_LE(map3.numChunks(), 32);
+    }
+    BOOST_CHECK_GT(map3.chunksGenerated(), 32);
+}
@@ -44,6 +44,10 @@ namespace
     Point nextHex;  // where to move the selected hex
     Point pathToHex;  // highlight a path to here
     Point pathToHexPrev;
+
+    // Spend at most this long per frame finding paths.  Hard paths take
+    // several frames rather than making one frame take longer.
+    const double pathBudget_ms = 2.0;
 }
 
 // Try to center the minimap's bounding box at the given screen coordinates,
@@ -53,8 +57,8 @@ void moveMiniBoxCenter(Sint16 px, Sint16 py)
     Sint16 tgtX = px - miniBox.w / 2;
     Sint16 tgtY = py - miniBox.h / 2;
     auto pct = rectPct(tgtX, tgtY, minimapArea);
-    Sint16 tgtMapX = pct.first * rmap->pWidth();
-    Sint16 tgtMapY = pct.second * rmap->pHeight();
+    int tgtMapX = pct.first * rmap->pWidth();
+    int tgtMapY = pct.second * rmap->pHeight();
     auto mapLimit = rmap->maxPixel();
     tgtMapX = bound(tgtMapX, 0, mapLimit.first);
     tgtMapY = bound(tgtMapY, 0, mapLimit.second);
@@ -64,47 +68,47 @@ void moveMiniBoxCenter(Sint16 px, Sint16 py)
 
 void scrollMap(Dir8 direction)
 {
-    const Sint16 mapScrollRate_pps = pHexSize * 4;  // pixels per second
-    const Sint16 pScroll = std::max<Sint16>(1, mapScrollRate_pps * elapsed_ms /
-                                               1000);
-    const Sint16 pScrollDiag = std::max<Sint16>(1,
+    const int mapScrollRate_pps = pHexSize * 4;  // pixels per second
+    const int pScroll = std::max<int>(1, mapScrollRate_pps * elapsed_ms /
+                                      1000);
+    const int pScrollDiag = std::max<int>(1,
         mapScrollRate_pps * elapsed_ms / 1000 / std::sqrt(2));
 
     auto curPixel = rmap->mDrawnAt();
-    Sint16 px = curPixel.first;
-    Sint16 py = curPixel.second;
+    int px = curPixel.first;
+    int py = curPixel.second;
     auto maxPixel = rmap->maxPixel();
-    Sint16 maxX = maxPixel.first;
-    Sint16 maxY = maxPixel.second;
+    int maxX = maxPixel.first;
+    int maxY = maxPixel.second;
 
     switch (direction) {
         case Dir8::N:
-            py = std::max<Sint16>(0, py - pScroll);
+            py = std::max<int>(0, py - pScroll);
             break;
         case Dir8::NE:
-            px = std::min<Sint16>(maxX, px + pScrollDiag);
-            py = std::max<Sint16>(0, curPixel.second - pScrollDiag);
+            px = std::min<int>(maxX, px + pScrollDiag);
+            py = std::max<int>(0, curPixel.second - pScrollDiag);
             break;
         case Dir8::E:
-            px = std::min<Sint16>(maxX, px + pScroll);
+            px = std::min<int>(maxX, px + pScroll);
             break;
         case Dir8::SE:
-            px = std::min<Sint16>(maxX, px + pScrollDiag);
-            py = std::min<Sint16>(maxY, py + pScrollDiag);
+            px = std::min<int>(maxX, px + pScrollDiag);
+            py = std::min<int>(maxY, py + pScrollDiag);
             break;
         case Dir8::S:
-            py = std::min<Sint16>(maxY, py + pScroll);
+            py = std::min<int>(maxY, py + pScroll);
             break;
         case Dir8::SW:
-            px = std::max<Sint16>(0, px - pScrollDiag);
-            py = std::min<Sint16>(maxY, py + pScroll);
+            px = std::max<int>(0, px - pScrollDiag);
+            py = std::min<int>(maxY, py + pScroll);
             break;
         case Dir8::W:
-            px = std::max<Sint16>(0, px - pScroll);
+            px = std::max<int>(0, px - pScroll);
             break;
         case Dir8::NW:
-            px = std::max<Sint16>(0, px - pScrollDiag);
-            py = std::max<Sint16>(0, curPixel.second - pScrollDiag);
+            px = std::max<int>(0, px - pScrollDiag);
+            py = std::max<int>(0, curPixel.second - pScrollDiag);
             break;
         default:
             break;
@@ -169,6 +173,7 @@ extern "C" int SDL_main(int, char **)  // 2-arg form is required by SDL
     }
 
     rmap = make_unique<RandomMap>(32, 18, mapArea);
+    rmap->setCollectStats(true);
     mini = make_unique<Minimap>(*rmap, minimapArea);
     timeNearEdge_ms = 0;
     mouseNearMapEdge = Dir8::None;
@@ -191,6 +196,9 @@ extern "C" int SDL_main(int, char **)  // 2-arg form is required by SDL
     SDL_UpdateRect(screen, 0, 0, 0, 0);
 
     std::vector<Uint32> frames;
+    int pathFrames = 0;  // frames spent on the current path request
+    int slowestPathFrames = 0;
+    PathStats slowestPath;
     bool isDone = false;
     auto prevFrameTime_ms = SDL_GetTicks();
     SDL_Event event;
@@ -233,12 +241,37 @@ extern "C" int SDL_main(int, char **)  // 2-arg form is required by SDL
             }
         }
 
-        if (nextMapLoc != rmap->mDrawnAt() ||
-            nextHex != rmap->getSelectedHex() ||
-            pathToHex != pathToHexPrev)
-        {
+        // Scrolling the map doesn't change the path.
+        bool pathChanged = nextHex != rmap->getSelectedHex() ||
+            pathToHex != pathToHexPrev;
+        bool needRedraw = false;
+        if (nextMapLoc != rmap->mDrawnAt() || pathChanged) {
             rmap->selectHex(nextHex);
-            rmap->highlightPath(rmap->getSelectedHex(), pathToHex);
+            if (pathChanged) {
+                rmap->requestPath(rmap->getSelectedHex(), pathToHex);
+                pathFrames = 0;
+            }
+            needRedraw = true;
+        }
+
+        // Keep showing the old path until the new one is ready.
+        if (rmap->pathPending()) {
+            SliceBudget budget(-1, pathBudget_ms);
+            if (rmap->updatePath(budget)) {
+                PathStats pathStats;
+                for (const auto &leg : rmap->getPathStats()) {
+                    pathStats += leg;
+                }
+                if (pathStats.elapsed_ms > slowestPath.elapsed_ms) {
+                    slowestPath = pathStats;
+                }
+                needRedraw = true;
+            }
+            ++pathFrames;
+            slowestPathFrames = std::max(slowestPathFrames, pathFrames);
+        }
+
+        if (needRedraw) {
             rmap->draw(nextMapLoc.first, nextMapLoc.second);
             mini->draw();
             mini->drawBoundingBox();
@@ -251,5 +284,12 @@ extern "C" int SDL_main(int, char **)  // 2-arg form is required by SDL
     std::cout << "Average frame time: " << accumulate(std::begin(frames), std::end(frames), 0) / static_cast<double>(frames.size()) << '\n';
     std::cout << "Minimum frame: " << *min_element(std::begin(frames), std::end(frames)) << '\n';
     std::cout << "Maximum frame: " << *max_element(std::begin(frames), std::end(frames)) << '\n';
+    std::cout << "Slowest path: " << slowestPath.elapsed_ms << " ms, " <<
+        slowestPath.searches << " searches, " << slowestPath.expanded <<
+        " nodes expanded, peak open list " << slowestPath.peakOpen << '\n';
+    std::cout << "Most frames for one path: " << slowestPathFrames << '\n';
+    const auto &cache = rmap->getPathCache();
+    std::cout << "Path cache hits: " << cache.hits() << ", misses: " <<
+        cache.misses() << '\n';
     return EXIT_SUCCESS;
 }
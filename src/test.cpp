@@ -13,7 +13,9 @@
 #define BOOST_TEST_MODULE Hex_Utils_Test
 #include <boost/test/unit_test.hpp>
 
+#include "FixedHexGrid.h"
 #include "HexGrid.h"
+#include "HexLayer.h"
 #include "algo.h"
 #include "hex_utils.h"
 
@@ -23,6 +25,11 @@ BOOST_AUTO_TEST_CASE(Distance)
     BOOST_CHECK_EQUAL(hexDist({4, 4}, {3, 3}), 1);
     BOOST_CHECK_EQUAL(hexDist({1, 1}, {3, 3}), 3);
     BOOST_CHECK_EQUAL(hexDist({7, 7}, {5, 5}), 3);
+
+    // Negative columns are staggered the same way as positive ones.
+    BOOST_CHECK_EQUAL(hexDist({2, 0}, {3, 1}), 2);
+    BOOST_CHECK_EQUAL(hexDist({-2, 0}, {-1, 1}), 2);
+    BOOST_CHECK_EQUAL(hexDist({-1, 1}, {-2, 0}), 2);
 }
 
 BOOST_AUTO_TEST_CASE(Array_Index_To_Hex)
@@ -91,3 +98,119 @@ BOOST_AUTO_TEST_CASE(Hex_Get_Neighbor)
                           str(grid.hexFromAry(grid.aryGetNeighbor(a2, d))));
     }
 }
+
+// Array neighbors are computed without going through a Point.  Make sure they
+// agree everywhere, including the edges of a grid with an odd width.
+BOOST_AUTO_TEST_CASE(Ary_Get_Neighbor_All)
+{
+    HexGrid grid(7, 5);
+    for (int a = 0; a < grid.size(); ++a) {
+        auto hex = grid.hexFromAry(a);
+        for (auto d : Dir()) {
+            BOOST_CHECK_EQUAL(grid.aryGetNeighbor(a, d),
+                              grid.aryFromHex(grid.hexGetNeighbor(hex, d)));
+        }
+    }
+    BOOST_CHECK_EQUAL(grid.aryGetNeighbor(-1, Dir::N), -1);
+    BOOST_CHECK_EQUAL(grid.aryGetNeighbor(grid.size(), Dir::N), -1);
+}
+
+// Grids bigger than 32767 hexes used to overflow.
+BOOST_AUTO_TEST_CASE(Large_Grid)
+{
+    HexGrid grid(40000, 2048);
+    BOOST_CHECK_EQUAL(grid.size(), 40000 * 2048);
+
+    auto aLast = grid.aryCorner(Dir::SE);
+    BOOST_CHECK_EQUAL(aLast, grid.size() - 1);
+    BOOST_CHECK_EQUAL(str(grid.hexFromAry(aLast)), str(Point{39999, 2047}));
+    BOOST_CHECK_EQUAL(grid.aryFromHex(39999, 2047), aLast);
+    BOOST_CHECK_EQUAL(hexDist({0, 0}, {39999, 0}), 39999);
+    BOOST_CHECK_EQUAL(grid.aryGetNeighbor(aLast, Dir::SE), -1);
+}
+
+// Everything about a fixed size grid can be worked out at compile time.
+static_assert(FixedHexGrid<5, 5>::aryGetNeighbor(0, Dir::S) == 5, "");
+static_assert(FixedHexGrid<5, 5>::aryGetNeighbor(0, Dir::N) == -1, "");
+static_assert(FixedHexGrid<5, 5>::aryCorner(Dir::SE) == 24, "");
+static_assert(FixedHexGrid<5, 5>::hexFromAry(7).first == 2, "");
+
+// Count the hexes that have all six neighbors, written once for any kind of
+// grid.
+template <typename Grid>
+int countInterior(const Grid &grid)
+{
+    int count = 0;
+    for (int a = 0; a < grid.size(); ++a) {
+        if (grid.aryNeighbors(a).size() == 6) ++count;
+    }
+    return count;
+}
+
+BOOST_AUTO_TEST_CASE(Fixed_Grid)
+{
+    FixedHexGrid<7, 5> fixed;
+    HexGrid grid = fixed;
+    BOOST_CHECK_EQUAL(grid.size(), fixed.size());
+    BOOST_CHECK_EQUAL(countInterior(fixed), countInterior(grid));
+
+    for (int a = -1; a <= grid.size(); ++a) {
+        auto hex = grid.hexFromAry(a);
+        BOOST_CHECK_EQUAL(str(fixed.hexFromAry(a)), str(hex));
+        for (auto d : Dir()) {
+            BOOST_CHECK_EQUAL(fixed.aryGetNeighbor(a, d),
+                              grid.aryGetNeighbor(a, d));
+            if (hex != hInvalid) {
+                BOOST_CHECK_EQUAL(str(fixed.hexGetNeighbor(hex, d)),
+                                  str(grid.hexGetNeighbor(hex, d)));
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(str(fixed.hexCorner(Dir::SW)),
+                      str(grid.hexCorner(Dir::SW)));
+}
+
+// Both layouts should see the same values no matter how they're visited.
+BOOST_AUTO_TEST_CASE(Layers)
+{
+    HexGrid grid(37, 21);  // not a multiple of the chunk size
+    LinearLayer<int> linear(grid);
+    ChunkedLayer<int> chunked(grid);
+    for (int a = 0; a < grid.size(); ++a) {
+        linear[a] = a * 7;
+        chunked[a] = a * 7;
+    }
+
+    for (int a = 0; a < grid.size(); ++a) {
+        auto hex = grid.hexFromAry(a);
+        BOOST_CHECK_EQUAL(chunked.at(hex), a * 7);
+        BOOST_CHECK_EQUAL(linear.at(hex), a * 7);
+
+        std::vector<int> lNbrs;
+        std::vector<int> cNbrs;
+        linear.forEachNeighbor(a, [&] (int n, int value) {
+            BOOST_CHECK_EQUAL(value, n * 7);
+            lNbrs.push_back(n);
+        });
+        chunked.forEachNeighbor(a, [&] (int n, int value) {
+            BOOST_CHECK_EQUAL(value, n * 7);
+            cNbrs.push_back(n);
+        });
+        BOOST_CHECK(lNbrs == cNbrs);
+    }
+
+    // Rectangles hanging off the grid get clipped.
+    std::vector<int> lRect;
+    std::vector<int> cRect;
+    linear.forEachInRect({-3, 10}, {20, 30}, [&] (int a, int value) {
+        BOOST_CHECK_EQUAL(value, a * 7);
+        lRect.push_back(a);
+    });
+    chunked.forEachInRect({-3, 10}, {20, 30}, [&] (int a, int value) {
+        BOOST_CHECK_EQUAL(value, a * 7);
+        cRect.push_back(a);
+    });
+    BOOST_CHECK_EQUAL(lRect.size(), 21u * 11u);
+    sort(std::begin(cRect), std::end(cRect));
+    BOOST_CHECK(lRect == cRect);
+}